@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "list.h"
+
+/**
+ * @brief ARENA_ALIGNMENT is the alignment of every @ref arena_t allocation.
+ */
+#define ARENA_ALIGNMENT 16
+
+/**
+ * @brief ARENA_SIZE_CLASSES is the number of size classes recycled by an
+ * @ref arena_t, each @ref ARENA_ALIGNMENT bytes larger than the last.
+ */
+#define ARENA_SIZE_CLASSES 32
+
+/**
+ * @brief arena_block_t links an allocation too large for any size class.
+ */
+typedef struct arena_block_t {
+    /*! the previous large allocation. */
+    struct arena_block_t* prev;
+    /*! the next large allocation. */
+    struct arena_block_t* next;
+} arena_block_t;
+
+/**
+ * @brief arena_t is a chunked allocator for many small, short-lived blocks.
+ * 
+ * arena_t hands out blocks by bumping a cursor through large chunks, so
+ * allocating n small blocks takes roughly n / chunk allocations from the
+ * system allocator. Released blocks are kept on a free list per size class
+ * and reused by later allocations of the same class. Blocks larger than the
+ * biggest size class are allocated individually. All blocks are freed
+ * together by @ref arena_clear or @ref arena_free.
+ */
+typedef struct arena_t {
+    /*! chunks is a @ref list_t of the chunks blocks are carved from. */
+    list_t* chunks;
+    /*! the next unused byte of the current chunk. */
+    char* cursor;
+    /*! the number of unused bytes left in the current chunk. */
+    int64_t remaining;
+    /*! the size of each chunk. */
+    int64_t chunk_size;
+    /*! free_lists holds the released blocks of each size class. */
+    void* free_lists[ARENA_SIZE_CLASSES];
+    /*! large is the list of allocations too large for any size class. */
+    arena_block_t* large;
+    /*! the number of bytes requested by live allocations. */
+    int64_t bytes;
+} arena_t;
+
+/**
+ * @brief arena_new returns a new @ref arena_t instance.
+ * 
+ * @relates arena_t
+ * 
+ * @param chunk_size the number of bytes in each chunk.
+ * 
+ * @return arena_t* a new @ref arena_t instance.
+ */
+arena_t* arena_new(int64_t chunk_size);
+
+/**
+ * @brief arena_free frees the memory of @p self and every block allocated
+ * from it.
+ * 
+ * @relates arena_t
+ * 
+ * @param self the @ref arena_t instance.
+ */
+void arena_free(arena_t* self);
+
+/**
+ * @brief arena_clear frees every block allocated from @p self, keeping one
+ * chunk for reuse.
+ * 
+ * @relates arena_t
+ * 
+ * @param self the @ref arena_t instance.
+ * 
+ * @return arena_t* @p self.
+ */
+arena_t* arena_clear(arena_t* self);
+
+/**
+ * @brief arena_alloc returns a block of at least @p size bytes.
+ * 
+ * @relates arena_t
+ * 
+ * @param self the @ref arena_t instance.
+ * @param size the number of bytes to allocate.
+ * 
+ * @return void* a block aligned to @ref ARENA_ALIGNMENT bytes.
+ */
+void* arena_alloc(arena_t* self, int64_t size);
+
+/**
+ * @brief arena_release returns a block to @p self for reuse.
+ * 
+ * @relates arena_t
+ * 
+ * @param self the @ref arena_t instance.
+ * @param ptr the block returned by @ref arena_alloc.
+ * @param size the size passed to @ref arena_alloc for @p ptr.
+ */
+void arena_release(arena_t* self, void* ptr, int64_t size);
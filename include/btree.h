@@ -0,0 +1,204 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "cstrings.h"
+
+/**
+ * @brief BTREE_ORDER is the maximum number of keys in a @ref btree_node_t.
+ */
+#define BTREE_ORDER 32
+
+/**
+ * @brief btree_node_t is an inner node or leaf of a @ref btree_t.
+ *
+ * Each key is stored next to the first 8 bytes of its data, packed into a
+ * big-endian integer, so searching a node mostly compares integers within
+ * one contiguous array and only reads key data to break ties.
+ */
+typedef struct btree_node_t {
+    /*! true if this node is a leaf. */
+    bool leaf;
+    /*! the number of keys in this node. */
+    int32_t count;
+    /*! prefixes holds the first 8 bytes of each key, big-endian. */
+    uint64_t prefixes[BTREE_ORDER];
+    /*! keys holds the keys in order, whose data is owned by the tree. */
+    string_t keys[BTREE_ORDER];
+    union {
+        /*! values holds the value of each key of a leaf. */
+        void* values[BTREE_ORDER];
+        /*! children holds the count + 1 children of an inner node, where
+         * keys[i] is the smallest key under children[i + 1]. */
+        struct btree_node_t* children[BTREE_ORDER + 1];
+    };
+    /*! the previous leaf in key order, or NULL. */
+    struct btree_node_t* prev;
+    /*! the next leaf in key order, or NULL. */
+    struct btree_node_t* next;
+} btree_node_t;
+
+/**
+ * @brief btree_t is an ordered map for looking up values with a
+ * @ref string_t key.
+ *
+ * btree_t is a B+tree: every key-value pair lives in a leaf, leaves are
+ * linked in key order, and inner nodes only hold separator keys. Nodes are
+ * up to @ref BTREE_ORDER keys wide, so a tree of 50M keys is about six
+ * levels deep. Key data is copied into an @ref arena_t owned by the tree.
+ *
+ * Deleting a key never merges nodes; a node is only freed once it is
+ * empty. Iterators start at a lower bound and walk the linked leaves.
+ */
+typedef struct btree_t {
+    /*! the root node. */
+    btree_node_t* root;
+    /*! the number of key-value pairs. */
+    int64_t size;
+    /*! arena holds the key data. */
+    arena_t* arena;
+} btree_t;
+
+/**
+ * @brief btree_iter_t is a cursor over the key-value pairs of a
+ * @ref btree_t, in key order.
+ *
+ * The @ref btree_t must not be modified until the walk is finished.
+ */
+typedef struct btree_iter_t {
+    /*! the current leaf, or NULL once every pair was visited. */
+    btree_node_t* leaf;
+    /*! the index of the current pair in the current leaf. */
+    int32_t index;
+    /*! the prefix every visited key must start with, or NULL. */
+    string_t const* prefix;
+    /*! the current key, owned by the @ref btree_t. */
+    string_t* key;
+    /*! the current value. */
+    void* value;
+} btree_iter_t;
+
+/**
+ * @brief btree_new returns a new, empty @ref btree_t instance.
+ *
+ * @relates btree_t
+ *
+ * @return btree_t* a new @ref btree_t instance.
+ */
+btree_t* btree_new(void);
+
+/**
+ * @brief btree_free frees the memory of @p self.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ */
+void btree_free(btree_t* self);
+
+/**
+ * @brief btree_set adds a key-value pair to @p self, replacing the value of
+ * @p key if present.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ * @param key the key for the key-value pair, copied if inserted.
+ * @param value the value for the key-value pair.
+ *
+ * @return btree_t* @p self.
+ */
+btree_t* btree_set(btree_t* self, string_t* key, void* value);
+
+/**
+ * @brief btree_get returns the value matching the given @p key, else NULL
+ * if no match was found.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ * @param key the key to lookup.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* btree_get(btree_t* self, string_t* key);
+
+/**
+ * @brief btree_delete removes the key-value pair matching @p key.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ * @param key the key to search for deletion.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* btree_delete(btree_t* self, string_t* key);
+
+/**
+ * @brief btree_size returns the number of key-value pairs in @p self.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ *
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t btree_size(btree_t* self);
+
+/**
+ * @brief btree_iter returns a @ref btree_iter_t positioned before the
+ * smallest key of @p self.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ *
+ * @return btree_iter_t a cursor over every pair of @p self.
+ */
+btree_iter_t btree_iter(btree_t* self);
+
+/**
+ * @brief btree_lower_bound returns a @ref btree_iter_t positioned before
+ * the smallest key of @p self that is not less than @p key.
+ *
+ * Walking the returned cursor until a key is past some upper bound visits
+ * a range of keys in O(log n + k) time.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ * @param key the lower bound.
+ *
+ * @return btree_iter_t a cursor starting at @p key.
+ */
+btree_iter_t btree_lower_bound(btree_t* self, string_t* key);
+
+/**
+ * @brief btree_prefix returns a @ref btree_iter_t over the keys of @p self
+ * that start with @p prefix.
+ *
+ * @p prefix must outlive the walk.
+ *
+ * @relates btree_t
+ *
+ * @param self the @ref btree_t instance.
+ * @param prefix the prefix of every visited key.
+ *
+ * @return btree_iter_t a cursor over the keys starting with @p prefix.
+ */
+btree_iter_t btree_prefix(btree_t* self, string_t* prefix);
+
+/**
+ * @brief btree_iter_next advances @p iter to the next key-value pair.
+ *
+ * @relates btree_iter_t
+ *
+ * @param iter the @ref btree_iter_t instance.
+ *
+ * @return bool true if @p iter points at a pair, else false once every
+ * pair was visited.
+ */
+bool btree_iter_next(btree_iter_t* iter);
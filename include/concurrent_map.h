@@ -0,0 +1,134 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdalign.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+/**
+ * @brief concurrent_map_shard_t is one independently locked part of a
+ * @ref concurrent_map_t.
+ */
+typedef struct concurrent_map_shard_t {
+    /*! lock guards @ref map, and is aligned so shards never share a cache line. */
+    alignas(64) pthread_rwlock_t lock;
+    /*! map holds the key-value pairs whose hash selects this shard. */
+    map_t* map;
+} concurrent_map_shard_t;
+
+/**
+ * @brief concurrent_map_t is a thread-safe hash map for looking up values
+ * with a @ref string_t key.
+ * 
+ * concurrent_map_t splits its keys across a power of two number of shards
+ * using the high bits of @ref string_hash, and each shard is a flat
+ * @ref map_t guarded by its own reader-writer lock. Readers of a shard run
+ * in parallel, and writers only block operations on the same shard. Keys
+ * passed in are never written to, so threads may share one key object.
+ */
+typedef struct concurrent_map_t {
+    /*! shards is the array of independently locked shards. */
+    concurrent_map_shard_t* shards;
+    /*! the number of shards. */
+    int64_t shard_count;
+    /*! the number of high hash bits used to select a shard. */
+    int shard_bits;
+} concurrent_map_t;
+
+/**
+ * @brief concurrent_map_new returns a new @ref concurrent_map_t instance.
+ * 
+ * concurrent_map_new returns a new @ref concurrent_map_t instance with
+ * @p shard_count shards, rounded up to a power of two, each reserving space
+ * for @p shard_capacity key-value pairs.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param shard_count the number of independently locked shards.
+ * @param shard_capacity the initial capacity of each shard.
+ * 
+ * @return concurrent_map_t* a new @ref concurrent_map_t instance.
+ */
+concurrent_map_t* concurrent_map_new(int64_t shard_count, int64_t shard_capacity);
+
+/**
+ * @brief concurrent_map_free frees the memory of @p self.
+ * 
+ * concurrent_map_free must not run concurrently with any other operation
+ * on @p self.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param self the @ref concurrent_map_t instance.
+ */
+void concurrent_map_free(concurrent_map_t* self);
+
+/**
+ * @brief concurrent_map_clear clears all shards in @p self, freeing any
+ * stored keys.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param self the @ref concurrent_map_t instance.
+ * 
+ * @return concurrent_map_t* @p self.
+ */
+concurrent_map_t* concurrent_map_clear(concurrent_map_t* self);
+
+/**
+ * @brief concurrent_map_set adds a key-value pair to the
+ * @ref concurrent_map_t instance.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param self the @ref concurrent_map_t instance.
+ * @param key the key for the key-value pair.
+ * @param value the value for the key-value pair.
+ * 
+ * @return concurrent_map_t* @p self.
+ */
+concurrent_map_t* concurrent_map_set(concurrent_map_t* self, string_t* key, void* value);
+
+/**
+ * @brief concurrent_map_delete removes the key-value pair matching @p key.
+ * 
+ * concurrent_map_delete removes the key-value pair matching @p key,
+ * returning the value if @p key matches a key-value pair, else NULL.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param self the @ref concurrent_map_t instance.
+ * @param key the key to search for deletion.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* concurrent_map_delete(concurrent_map_t* self, string_t* key);
+
+/**
+ * @brief concurrent_map_get returns the value matching the given @p key,
+ * else NULL if no match was found.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param self the @ref concurrent_map_t instance.
+ * @param key the key to lookup.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* concurrent_map_get(concurrent_map_t* self, string_t* key);
+
+/**
+ * @brief concurrent_map_size returns the number of key-value pairs in
+ * @p self.
+ * 
+ * concurrent_map_size locks each shard in turn, so the result is only
+ * exact if no writers run concurrently.
+ * 
+ * @relates concurrent_map_t
+ * 
+ * @param self the @ref concurrent_map_t instance.
+ * 
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t concurrent_map_size(concurrent_map_t* self);
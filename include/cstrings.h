@@ -3,6 +3,11 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/**
+ * @brief CRUMB_STRING_SEED is the XXH64 seed used by @ref string_hash.
+ */
+#define CRUMB_STRING_SEED 4374805547167856529ULL
+
 /**
  * @brief string_t is a string data structure.
  */
@@ -11,6 +16,8 @@ typedef struct string_t {
     char* buf;
     /*! the length of the string. */
     int64_t length;
+    /*! the cached hash of the string data, or 0 if not yet computed. */
+    uint64_t hash;
 } string_t;
 
 /**
@@ -28,6 +35,23 @@ typedef struct string_t {
  */
 string_t* string(char const* str, int64_t length);
 
+/**
+ * @brief string_view returns a @ref string_t referencing @p length
+ * characters of @p str without copying them.
+ * 
+ * string_view allocates nothing. The returned @ref string_t borrows
+ * @p str, which must outlive it, and must not be passed to
+ * @ref string_free. Its hash is computed lazily by @ref string_hash.
+ * 
+ * @relates string_t
+ * 
+ * @param str the raw string data to reference.
+ * @param length the length of the string.
+ * 
+ * @return string_t a @ref string_t referencing @p str.
+ */
+string_t string_view(char const* str, int64_t length);
+
 /**
  * @brief string_copy returns a copy of @p self.
  * 
@@ -59,6 +83,8 @@ void string_free(string_t* self);
  * string_equal returns true if two @ref string_t instances are equal, where
  * equality is defined by identity and data. Data comparison may take O(n)
  * time if the two @ref string_t instances are equal in data but not identity.
+ * If both hashes are already cached, differing hashes return false without
+ * comparing data.
  * 
  * @relates string_t
  * 
@@ -70,6 +96,22 @@ void string_free(string_t* self);
  */
 bool string_equal(string_t const* lhs, string_t const* rhs);
 
+/**
+ * @brief string_compare orders two @ref string_t instances
+ * lexicographically by their bytes.
+ * 
+ * A string that is a prefix of another orders before it.
+ * 
+ * @relates string_t
+ * 
+ * @param lhs the @ref string_t on the left side of the comparison.
+ * @param rhs the @ref string_t on the right side of the comparison.
+ * 
+ * @return int a negative number if @p lhs orders before @p rhs, a
+ * positive number if after, else 0 if their data is equal.
+ */
+int string_compare(string_t const* lhs, string_t const* rhs);
+
 /**
  * @brief string_data returns the underlying memory buffer of @p self.
  * 
@@ -106,3 +148,36 @@ int64_t string_length(string_t const* self);
  * @return string_t* a subtring of @p self or NULL if out of bounds.
  */
 string_t* string_substr(string_t const* self, int64_t start, int64_t end);
+
+/**
+ * @brief string_hash returns the hash of the data in @p self.
+ * 
+ * string_hash computes the XXH64 hash of the data in @p self the first time
+ * it is called, and returns the cached hash afterwards. Copies made with
+ * @ref string_copy share the cached hash. The cache is not invalidated if
+ * the buffer returned by @ref string_data is modified.
+ * 
+ * @relates string_t
+ * 
+ * @param self the @ref string_t instance.
+ * 
+ * @return uint64_t the hash of the data in @p self.
+ */
+uint64_t string_hash(string_t* self);
+
+/**
+ * @brief string_hash_uncached returns the hash of the data in @p self
+ * without caching it.
+ * 
+ * string_hash_uncached returns the cached hash of @p self if one was
+ * already computed, and otherwise computes it like @ref string_hash but
+ * never writes to @p self. Threads sharing one @ref string_t can call it
+ * concurrently.
+ * 
+ * @relates string_t
+ * 
+ * @param self the @ref string_t instance.
+ * 
+ * @return uint64_t the hash of the data in @p self.
+ */
+uint64_t string_hash_uncached(string_t const* self);
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "list.h"
+
+/**
+ * @brief deque_t is a double-ended queue stored in a circular buffer.
+ *
+ * Unlike @ref list_prepend and popping the first element of a
+ * @ref list_t, which shift every element, deque_t moves its head index
+ * instead, so pushing and popping at either end takes amortized O(1) time.
+ * Elements are still addressed by index through @ref deque_get and
+ * @ref deque_set. The capacity is always a power of two, so wrapping an
+ * index is a single mask.
+ */
+typedef struct deque_t {
+    /*! the underlying circular memory buffer. */
+    void** buf;
+    /*! the size of the memory buffer, always a power of two. */
+    int64_t capacity;
+    /*! the position of the first element in the memory buffer. */
+    int64_t head;
+    /*! the number of elements in the @ref deque_t. */
+    int64_t size;
+} deque_t;
+
+/**
+ * @brief deque_new returns a new @ref deque_t instance.
+ *
+ * deque_new returns a new @ref deque_t instance with enough memory for
+ * storing at least @p capacity values before growing.
+ *
+ * @relates deque_t
+ *
+ * @param capacity the initial memory buffer size, rounded up to a power
+ * of two.
+ *
+ * @return deque_t* a new @ref deque_t instance.
+ */
+deque_t* deque_new(int64_t capacity);
+
+/**
+ * @brief deque_free frees the memory of @p self.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ */
+void deque_free(deque_t* self);
+
+/**
+ * @brief deque_clear clears all elements in @p self.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ *
+ * @return deque_t* @p self.
+ */
+deque_t* deque_clear(deque_t* self);
+
+/**
+ * @brief deque_push_back appends @p value to the end of @p self.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ * @param value the value to append.
+ *
+ * @return deque_t* @p self.
+ */
+deque_t* deque_push_back(deque_t* self, void* value);
+
+/**
+ * @brief deque_push_front adds @p value to the beginning of @p self.
+ *
+ * No element is moved unless the memory buffer grows.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ * @param value the value to prepend.
+ *
+ * @return deque_t* @p self.
+ */
+deque_t* deque_push_front(deque_t* self, void* value);
+
+/**
+ * @brief deque_pop_back removes and returns the last element of @p self.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ *
+ * @return void* the last element, or NULL if @p self is empty.
+ */
+void* deque_pop_back(deque_t* self);
+
+/**
+ * @brief deque_pop_front removes and returns the first element of
+ * @p self.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ *
+ * @return void* the first element, or NULL if @p self is empty.
+ */
+void* deque_pop_front(deque_t* self);
+
+/**
+ * @brief deque_get returns the element found at the given @p index,
+ * counted from the first element.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ * @param index the index of the element to get.
+ *
+ * @return void* the element at @p index, or NULL if out of bounds.
+ */
+void* deque_get(deque_t* self, int64_t index);
+
+/**
+ * @brief deque_set replaces the element at the given @p index.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ * @param index the index of the element to replace.
+ * @param value the new value.
+ *
+ * @return void* @p value if @p index is in bounds, else NULL.
+ */
+void* deque_set(deque_t* self, int64_t index, void* value);
+
+/**
+ * @brief deque_size returns the number of elements in a @ref deque_t.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ *
+ * @return int64_t the number of elements in @p self.
+ */
+int64_t deque_size(deque_t* self);
+
+/**
+ * @brief deque_capacity returns the size of the memory buffer of
+ * @p self.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ *
+ * @return int64_t the capacity of @p self.
+ */
+int64_t deque_capacity(deque_t* self);
+
+/**
+ * @brief deque_to_list returns a new @ref list_t holding the elements of
+ * @p self in order.
+ *
+ * @relates deque_t
+ *
+ * @param self the @ref deque_t instance.
+ *
+ * @return list_t* a new @ref list_t instance.
+ */
+list_t* deque_to_list(deque_t* self);
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+/**
+ * @brief frozen_map_slot_t is the key-value pair stored at one position of
+ * a @ref frozen_map_t.
+ */
+typedef struct frozen_map_slot_t {
+    /*! the hash of the key. */
+    uint64_t hash;
+    /*! the offset of the key data in the key blob. */
+    int64_t offset;
+    /*! the value. */
+    void* value;
+} frozen_map_slot_t;
+
+/**
+ * @brief frozen_map_t is an immutable hash map for looking up values with
+ * a @ref string_t key.
+ * 
+ * frozen_map_t places its keys with a minimal perfect hash function built
+ * in the style of CHD and PTHash: keys are split into small buckets, and
+ * each bucket stores a pilot value that displaces its keys onto distinct,
+ * otherwise unused slots. A lookup reads one pilot, one slot and compares
+ * one key, and the @p size slots hold no empty space. Key data is packed
+ * in slot order into one contiguous blob.
+ */
+typedef struct frozen_map_t {
+    /*! pilots holds the displacement of each bucket. */
+    uint32_t* pilots;
+    /*! the number of buckets. */
+    int64_t bucket_count;
+    /*! slots holds one key-value pair per slot, followed by a sentinel. */
+    frozen_map_slot_t* slots;
+    /*! the number of key-value pairs. */
+    int64_t size;
+    /*! blob holds the data of every key, in slot order. */
+    char* blob;
+    /*! the XXH64 seed used for hashing keys. */
+    uint64_t seed;
+} frozen_map_t;
+
+/**
+ * @brief frozen_map_hash returns the hash of @p key under @p seed.
+ * 
+ * @param seed the XXH64 seed.
+ * @param key the key to hash.
+ * 
+ * @return uint64_t the hash of @p key.
+ */
+uint64_t frozen_map_hash(uint64_t seed, string_t* key);
+
+/**
+ * @brief frozen_map_position returns the slot of a key with the given
+ * @p hash, once its bucket is displaced by @p pilot.
+ * 
+ * @param hash the hash of the key.
+ * @param pilot the pilot of the key's bucket.
+ * @param size the number of slots.
+ * 
+ * @return int64_t the slot of the key.
+ */
+int64_t frozen_map_position(uint64_t hash, uint64_t pilot, int64_t size);
+
+/**
+ * @brief map_freeze returns an immutable @ref frozen_map_t holding the
+ * key-value pairs of @p self.
+ * 
+ * map_freeze takes O(n) expected time and does not modify @p self, whose
+ * lifetime is not shared with the returned @ref frozen_map_t.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * 
+ * @return frozen_map_t* a new @ref frozen_map_t instance, or NULL in the
+ * astronomically unlikely case that no perfect hash function was found.
+ */
+frozen_map_t* map_freeze(map_t* self);
+
+/**
+ * @brief frozen_map_free frees the memory of @p self.
+ * 
+ * @relates frozen_map_t
+ * 
+ * @param self the @ref frozen_map_t instance.
+ */
+void frozen_map_free(frozen_map_t* self);
+
+/**
+ * @brief frozen_map_get returns the value matching the given @p key, else
+ * NULL if no match was found.
+ * 
+ * @relates frozen_map_t
+ * 
+ * @param self the @ref frozen_map_t instance.
+ * @param key the key to lookup.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* frozen_map_get(frozen_map_t* self, string_t* key);
+
+/**
+ * @brief frozen_map_size returns the number of key-value pairs in @p self.
+ * 
+ * @relates frozen_map_t
+ * 
+ * @param self the @ref frozen_map_t instance.
+ * 
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t frozen_map_size(frozen_map_t* self);
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include "typed_list.h"
+
 /**
  * @brief list_t is a dynamic-array data structure.
  */
@@ -25,6 +27,59 @@ typedef struct list_t {
  */
 typedef void(list_fn)(void* elem);
 
+/**
+ * @brief list_visit_fn is a callback function type for use with
+ * @ref list_foreach_parallel.
+ * 
+ * @relates list_t
+ * 
+ * @param elem the @ref list_t element.
+ * @param ctx the context pointer passed to @ref list_foreach_parallel.
+ */
+typedef void(list_visit_fn)(void* elem, void* ctx);
+
+/**
+ * @brief list_map_fn is a callback function type transforming one element
+ * for use with @ref list_reduce_parallel.
+ * 
+ * @relates list_t
+ * 
+ * @param elem the @ref list_t element.
+ * @param ctx the context pointer passed to @ref list_reduce_parallel.
+ * 
+ * @return void* the transformed element.
+ */
+typedef void*(list_map_fn)(void* elem, void* ctx);
+
+/**
+ * @brief list_reduce_fn is a callback function type combining two
+ * transformed elements for use with @ref list_reduce_parallel.
+ * 
+ * @relates list_t
+ * 
+ * @param lhs the result for the earlier elements.
+ * @param rhs the result for the later elements.
+ * @param ctx the context pointer passed to @ref list_reduce_parallel.
+ * 
+ * @return void* the combined result.
+ */
+typedef void*(list_reduce_fn)(void* lhs, void* rhs, void* ctx);
+
+/**
+ * @brief list_compare_fn is a comparison function type for use with
+ * @ref list_sort and the binary searches.
+ * 
+ * @relates list_t
+ * 
+ * @param lhs the element on the left side of the comparison.
+ * @param rhs the element on the right side of the comparison.
+ * @param ctx the context pointer passed to the sort or search.
+ * 
+ * @return int a negative number if @p lhs orders before @p rhs, 0 if they
+ * are equal, else a positive number.
+ */
+typedef int(list_compare_fn)(void* lhs, void* rhs, void* ctx);
+
 /**
  * @brief list_new returns a new @ref list_t instance.
  * 
@@ -108,6 +163,7 @@ list_t* list_extend(list_t* self, list_t* other);
  * 
  * list_prepend adds @p value to the beginning of the @ref list_t. All other
  * elements will be shifted to the right, potentially taking O(n) time.
+ * A @ref deque_t pushes at either end in O(1) time instead.
  * 
  * @relates list_t
  * 
@@ -186,7 +242,9 @@ int64_t list_capacity(list_t* self);
  * @brief list_find returns the index of @p value in @p self, if found.
  * 
  * list_find returns the index of @p value in @p self, or -1 if @p value
- * is not found.
+ * is not found. The scan compares several elements per instruction with
+ * the widest of AVX-512, AVX2 or SSE2 the CPU supports, detected on first
+ * use, and falls back to a scalar loop elsewhere.
  * 
  * @relates list_t
  * 
@@ -197,6 +255,23 @@ int64_t list_capacity(list_t* self);
  */
 int64_t list_find(list_t* self, void* value);
 
+/**
+ * @brief list_find_all returns the index of every occurrence of @p value
+ * in @p self.
+ * 
+ * list_find_all scans @p self once with the same kernel as
+ * @ref list_find.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param value the value to search for.
+ * 
+ * @return i64list_t* a new @ref i64list_t of the matching indices in
+ * ascending order, empty if @p value is not found.
+ */
+i64list_t* list_find_all(list_t* self, void* value);
+
 /**
  * @brief list_size returns the number of elements in a @ref list_t.
  * 
@@ -290,6 +365,108 @@ void* list_remove(list_t* self, void* value);
 void* list_set(list_t* self, int64_t index, void* value);
 
 
+/**
+ * @brief list_sort sorts the elements of @p self in place.
+ * 
+ * list_sort is a pattern-defeating quicksort: it sorts small ranges by
+ * insertion, picks pivots by median of three or, for large ranges, a
+ * ninther, moves runs of elements equal to the pivot aside in one pass,
+ * finishes nearly sorted ranges by insertion, and falls back to heapsort
+ * once too many partitions are unbalanced, so it takes O(n log n) time in
+ * the worst case and O(n) time for sorted input. The sort is not stable.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param cmp the function ordering two elements.
+ * @param ctx a context pointer passed to every call of @p cmp.
+ * 
+ * @return list_t* @p self.
+ */
+list_t* list_sort(list_t* self, list_compare_fn cmp, void* ctx);
+
+/**
+ * @brief list_sort_parallel sorts the elements of @p self in place using
+ * several threads.
+ * 
+ * list_sort_parallel splits @p self into one range per thread, sorts each
+ * range with @ref list_sort, then merges pairs of sorted ranges until one
+ * remains, using a temporary buffer of the same size as @p self. Each merge
+ * is split at co-ranks of its output into pieces merged in parallel, so the
+ * final merge uses every thread too. The ranges are sorted and merged by @ref thread_pool_default.
+ * Lists too small to be worth splitting are sorted on the calling thread.
+ * @p cmp must be safe to call from several threads at once.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param cmp the function ordering two elements.
+ * @param ctx a context pointer passed to every call of @p cmp.
+ * @param thread_count the maximum number of threads, or 0 for one per
+ * online CPU.
+ * 
+ * @return list_t* @p self.
+ */
+list_t* list_sort_parallel(list_t* self, list_compare_fn cmp, void* ctx, int64_t thread_count);
+
+/**
+ * @brief list_sort_strings sorts a @ref list_t of @ref string_t pointers
+ * in place, in the order of @ref string_compare.
+ * 
+ * list_sort_strings is a most significant digit radix sort: it buckets
+ * the strings by one byte at a time and never calls a comparison function,
+ * finishing small buckets by insertion. Each pass reads the byte of every
+ * string once into a scratch array, so the strings are not dereferenced
+ * again while they are scattered.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance, holding only @ref string_t
+ * pointers.
+ * 
+ * @return list_t* @p self.
+ */
+list_t* list_sort_strings(list_t* self);
+
+/**
+ * @brief list_lower_bound returns the index of the first element of
+ * @p self not ordered before @p value.
+ * 
+ * @p self must be sorted by @p cmp. The search takes O(log n) time.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param value the value to search for, passed as the right side of
+ * @p cmp.
+ * @param cmp the function ordering two elements.
+ * @param ctx a context pointer passed to every call of @p cmp.
+ * 
+ * @return int64_t the index of the first element not ordered before
+ * @p value, or the size of @p self if there is none.
+ */
+int64_t list_lower_bound(list_t* self, void* value, list_compare_fn cmp, void* ctx);
+
+/**
+ * @brief list_bsearch returns the index of an element of @p self equal to
+ * @p value.
+ * 
+ * @p self must be sorted by @p cmp. The search takes O(log n) time and
+ * finds the first of several equal elements.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param value the value to search for, passed as the right side of
+ * @p cmp.
+ * @param cmp the function ordering two elements.
+ * @param ctx a context pointer passed to every call of @p cmp.
+ * 
+ * @return int64_t the index of the first element equal to @p value, or -1
+ * if not found.
+ */
+int64_t list_bsearch(list_t* self, void* value, list_compare_fn cmp, void* ctx);
+
 /**
  * @brief list_fprint writes a string representation of a @ref list_t to @p stream.
  * 
@@ -309,3 +486,44 @@ void list_fprint(list_t* self, FILE* stream);
  * @param fn the function to call.
  */
 void list_foreach(list_t* self, list_fn fn);
+
+/**
+ * @brief list_foreach_parallel calls a function with each element in a
+ * @ref list_t, using the threads of @ref thread_pool_default.
+ * 
+ * The elements are split into chunks of @p grain elements, which the
+ * threads claim and steal from one another until every element was
+ * visited, in no particular order. @p fn is called from several threads
+ * at once, and @p self must not be modified until the call returns.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param fn the function to call.
+ * @param ctx a context pointer passed to every call of @p fn.
+ * @param grain the number of elements in each chunk, or 0 to pick one
+ * from the size of @p self and the number of threads.
+ */
+void list_foreach_parallel(list_t* self, list_visit_fn fn, void* ctx, int64_t grain);
+
+/**
+ * @brief list_reduce_parallel transforms each element of @p self with
+ * @p map and combines the results with @p reduce, using the threads of
+ * @ref thread_pool_default.
+ * 
+ * Each chunk of elements is reduced on one thread, then the chunk results
+ * are reduced in order on the calling thread, so @p reduce must be
+ * associative but need not be commutative. @p map and @p reduce are called
+ * from several threads at once.
+ * 
+ * @relates list_t
+ * 
+ * @param self the @ref list_t instance.
+ * @param map the function transforming each element.
+ * @param reduce the function combining two results.
+ * @param ctx a context pointer passed to every call of @p map and
+ * @p reduce.
+ * 
+ * @return void* the combined result, or NULL if @p self is empty.
+ */
+void* list_reduce_parallel(list_t* self, list_map_fn map, list_reduce_fn reduce, void* ctx);
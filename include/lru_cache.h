@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+/**
+ * @brief lru_policy_t is the eviction policy of a @ref lru_cache_t.
+ */
+typedef enum lru_policy_t {
+    /*! every hit moves the entry to the front, evicting the least recently
+     * used entry. */
+    LRU_POLICY_LRU,
+    /*! every hit only marks the entry as referenced; eviction gives marked
+     * entries a second chance, like a CLOCK hand. */
+    LRU_POLICY_CLOCK,
+} lru_policy_t;
+
+/**
+ * @brief lru_evict_fn is called with each key-value pair a
+ * @ref lru_cache_t evicts or replaces.
+ */
+typedef void(lru_evict_fn)(string_t* key, void* value, void* ctx);
+
+/**
+ * @brief lru_entry_t is a key-value pair of a @ref lru_cache_t, linked
+ * into its recency list, with the key data stored inline.
+ */
+typedef struct lru_entry_t {
+    /*! the more recently used entry, or NULL for the front. */
+    struct lru_entry_t* prev;
+    /*! the less recently used entry, or NULL for the back. */
+    struct lru_entry_t* next;
+    /*! the key, whose memory buffer points at @ref data. */
+    string_t key;
+    /*! the value. */
+    void* value;
+    /*! the share of the budget used by this entry. */
+    int64_t cost;
+    /*! true if this entry was hit since the CLOCK hand last passed it. */
+    bool referenced;
+    /*! the key data. */
+    char data[];
+} lru_entry_t;
+
+/**
+ * @brief lru_cache_stats_t holds the counters of a @ref lru_cache_t.
+ */
+typedef struct lru_cache_stats_t {
+    /*! the number of lookups that found their key. */
+    int64_t hits;
+    /*! the number of lookups that did not find their key. */
+    int64_t misses;
+    /*! the number of entries evicted to stay within the budget. */
+    int64_t evictions;
+    /*! the number of entries. */
+    int64_t size;
+    /*! the summed cost of every entry. */
+    int64_t cost;
+} lru_cache_stats_t;
+
+/**
+ * @brief lru_cache_t is a bounded cache for looking up values with a
+ * @ref string_t key.
+ *
+ * Entries are found through a flat @ref map_t and kept in an intrusive
+ * doubly linked recency list, so lookups, insertions and evictions are all
+ * O(1). Each entry has a cost, such as 1 for an entry budget or its size
+ * in bytes for a byte budget, and the least recently used entries are
+ * evicted whenever the summed cost exceeds the capacity.
+ *
+ * With @ref LRU_POLICY_CLOCK, hits only set a flag instead of relinking
+ * the entry, so lookups write to at most one entry.
+ */
+typedef struct lru_cache_t {
+    /*! map maps each key to its @ref lru_entry_t, borrowing the entry key. */
+    map_t* map;
+    /*! the most recently inserted or used entry. */
+    lru_entry_t* head;
+    /*! the next entry to evict. */
+    lru_entry_t* tail;
+    /*! the eviction policy. */
+    lru_policy_t policy;
+    /*! the maximum summed cost of every entry. */
+    int64_t capacity;
+    /*! the counters. */
+    lru_cache_stats_t stats;
+    /*! the function called with each evicted or replaced pair, or NULL. */
+    lru_evict_fn* on_evict;
+    /*! a context pointer passed to every call of @ref on_evict. */
+    void* ctx;
+} lru_cache_t;
+
+/**
+ * @brief lru_cache_new returns a new, empty @ref lru_cache_t instance.
+ *
+ * @relates lru_cache_t
+ *
+ * @param capacity the maximum summed cost of every entry.
+ * @param policy the eviction policy.
+ * @param on_evict the function called with each evicted or replaced
+ * key-value pair, or NULL.
+ * @param ctx a context pointer passed to every call of @p on_evict.
+ *
+ * @return lru_cache_t* a new @ref lru_cache_t instance.
+ */
+lru_cache_t* lru_cache_new(int64_t capacity, lru_policy_t policy, lru_evict_fn* on_evict, void* ctx);
+
+/**
+ * @brief lru_cache_free frees the memory of @p self.
+ *
+ * The remaining values are not passed to the eviction function.
+ *
+ * @relates lru_cache_t
+ *
+ * @param self the @ref lru_cache_t instance.
+ */
+void lru_cache_free(lru_cache_t* self);
+
+/**
+ * @brief lru_cache_get returns the value matching the given @p key, else
+ * NULL if no match was found, and marks the entry as recently used.
+ *
+ * @relates lru_cache_t
+ *
+ * @param self the @ref lru_cache_t instance.
+ * @param key the key to lookup.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* lru_cache_get(lru_cache_t* self, string_t* key);
+
+/**
+ * @brief lru_cache_put adds a key-value pair to @p self as the most
+ * recently used entry, then evicts entries until the summed cost fits the
+ * capacity.
+ *
+ * If @p key is present, its old value is replaced and passed to the
+ * eviction function, unless it is @p value itself. An entry costing more than the whole capacity is evicted
+ * right away.
+ *
+ * @relates lru_cache_t
+ *
+ * @param self the @ref lru_cache_t instance.
+ * @param key the key for the key-value pair, copied if inserted.
+ * @param value the value for the key-value pair.
+ * @param cost the share of the capacity used by the key-value pair.
+ *
+ * @return lru_cache_t* @p self.
+ */
+lru_cache_t* lru_cache_put(lru_cache_t* self, string_t* key, void* value, int64_t cost);
+
+/**
+ * @brief lru_cache_delete removes the key-value pair matching @p key
+ * without passing it to the eviction function.
+ *
+ * @relates lru_cache_t
+ *
+ * @param self the @ref lru_cache_t instance.
+ * @param key the key to search for deletion.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* lru_cache_delete(lru_cache_t* self, string_t* key);
+
+/**
+ * @brief lru_cache_size returns the number of entries in @p self.
+ *
+ * @relates lru_cache_t
+ *
+ * @param self the @ref lru_cache_t instance.
+ *
+ * @return int64_t the number of entries in @p self.
+ */
+int64_t lru_cache_size(lru_cache_t* self);
+
+/**
+ * @brief lru_cache_stats returns the counters of @p self.
+ *
+ * @relates lru_cache_t
+ *
+ * @param self the @ref lru_cache_t instance.
+ *
+ * @return lru_cache_stats_t the hit, miss and eviction counts, size and
+ * summed cost of @p self.
+ */
+lru_cache_stats_t lru_cache_stats(lru_cache_t* self);
@@ -1,21 +1,210 @@
 #pragma once
 
+#include "arena.h"
 #include "list.h"
 #include "cstrings.h"
 
+/**
+ * @brief map_engine_t selects the storage layout of a @ref map_t.
+ */
+typedef enum map_engine_t {
+    /*! key-value pairs are chained in a @ref list_t per bucket. */
+    MAP_ENGINE_CHAINED,
+    /*! key-value pairs are stored inline in contiguous, open-addressed slots. */
+    MAP_ENGINE_FLAT,
+} map_engine_t;
+
+/**
+ * @brief map_key_owner_t records who owns the data of a stored key.
+ */
+typedef enum map_key_owner_t {
+    /*! the key data was copied into the @ref map_t's @ref arena_t. */
+    MAP_KEY_INLINE,
+    /*! the key data was adopted by @ref map_set_take and is freed by the map. */
+    MAP_KEY_TAKEN,
+    /*! the key data was lent by @ref map_set_borrowed and outlives the map. */
+    MAP_KEY_BORROWED,
+} map_key_owner_t;
+
+/**
+ * @brief map_entry_t is a key-value pair stored by a chained @ref map_t.
+ * 
+ * Each entry is a single @ref arena_t block holding the key's length, hash
+ * and data next to the value. Taken and borrowed keys are not copied, and
+ * their memory buffer points outside the entry.
+ */
+typedef struct map_entry_t {
+    /*! the key and its hash, whose memory buffer points at @ref data. */
+    string_t key;
+    /*! the value. */
+    void* value;
+    /*! the @ref map_key_owner_t of the key data. */
+    uint8_t owner;
+    /*! the key data. */
+    char data[];
+} map_entry_t;
+
+/**
+ * @brief map_slot_t is a key-value pair stored inline by a flat @ref map_t.
+ */
+typedef struct map_slot_t {
+    /*! the key and its hash, whose memory buffer is owned by the @ref map_t
+     * unless the key was borrowed. */
+    string_t key;
+    /*! the value. */
+    void* value;
+} map_slot_t;
+
 /**
  * @brief map_t is a hash map for looking up values with a @ref string_t key.
+ * 
+ * A @ref map_t created with @ref map_new chains its key-value pairs in
+ * buckets. A @ref map_t created with @ref map_new_flat stores its key-value
+ * pairs in one contiguous array of slots, with a parallel array of control
+ * bytes holding 7 bits of each key's hash. Lookups in the flat engine
+ * compare a group of 16 control bytes at once (using SSE2 when available)
+ * and only touch slots whose control byte matches.
+ * 
+ * Both engines copy keys into an @ref arena_t owned by the @ref map_t, so
+ * storing a key allocates nothing in the common case, and deleted entries
+ * are recycled by later insertions. Keys stored with @ref map_set_take or
+ * @ref map_set_borrowed are referenced instead of copied.
  */
 typedef struct map_t {
+    /*! engine is the storage layout of the @ref map_t. */
+    map_engine_t engine;
     /*! buckets is a @ref list_t containing a list of key-value pairs. */
     list_t* buckets; 
+    /*! old_buckets holds the buckets still being migrated while growing. */
+    list_t* old_buckets;
+    /*! the index of the next bucket in old_buckets to migrate. */
+    int64_t migrate_index;
+    /*! the initial capacity for each bucket. */
+    int64_t bucket_capacity;
+    /*! ctrl holds one control byte per slot for the flat engine. */
+    uint8_t* ctrl;
+    /*! slots holds the key-value pairs for the flat engine. */
+    map_slot_t* slots;
+    /*! the number of slots for the flat engine. */
+    int64_t capacity;
+    /*! the number of key-value pairs in the @ref map_t. */
+    int64_t size;
+    /*! arena holds the stored entries and keys. */
+    arena_t* arena;
+    /*! the number of empty slots the flat engine may fill before growing. */
+    int64_t growth_left;
+    /*! owners holds the @ref map_key_owner_t of each flat slot, or NULL
+     * while every key is inline. */
+    uint8_t* owners;
+    /*! the number of stored keys adopted by @ref map_set_take. */
+    int64_t taken;
+    /*! the number of times the buckets or slots were grown or rehashed. */
+    int64_t resizes;
 } map_t;
 
+/**
+ * @brief map_iter_t is a cursor over the key-value pairs of a @ref map_t.
+ * 
+ * A map_iter_t points into the storage of its @ref map_t, so walking a
+ * map allocates nothing. The @ref map_t must not be modified until the walk
+ * is finished.
+ */
+typedef struct map_iter_t {
+    /*! the @ref map_t being walked. */
+    map_t* map;
+    /*! the buckets being walked by a chained @ref map_t. */
+    list_t* buckets;
+    /*! the current bucket, or slot for a flat @ref map_t. */
+    int64_t bucket;
+    /*! the current entry in the current bucket. */
+    int64_t index;
+    /*! the current key, owned by the @ref map_t. */
+    string_t* key;
+    /*! the current value. */
+    void* value;
+} map_iter_t;
+
+/**
+ * @brief MAP_STATS_HISTOGRAM_SIZE is the number of probe lengths counted
+ * separately by @ref map_stats_t.
+ */
+#define MAP_STATS_HISTOGRAM_SIZE 16
+
+/**
+ * @brief map_stats_t describes the layout and memory use of a @ref map_t.
+ * 
+ * The probe length of a key-value pair is the number of other places a
+ * lookup of its key visits first: its index in its bucket for a chained
+ * @ref map_t, or the number of groups probed before its own for a flat one.
+ */
+typedef struct map_stats_t {
+    /*! the storage layout. */
+    map_engine_t engine;
+    /*! the number of key-value pairs. */
+    int64_t size;
+    /*! the number of buckets, or slots for a flat @ref map_t, including
+     * buckets still being migrated. */
+    int64_t bucket_count;
+    /*! the number of key-value pairs per bucket or slot. */
+    double load_factor;
+    /*! the longest probe length of any key-value pair. */
+    int64_t max_probe_length;
+    /*! the mean probe length of the key-value pairs. */
+    double mean_probe_length;
+    /*! histogram counts the key-value pairs with each probe length, where
+     * the last entry also counts every longer probe. */
+    int64_t histogram[MAP_STATS_HISTOGRAM_SIZE];
+    /*! the number of key-value pairs not found at the first place probed. */
+    int64_t collisions;
+    /*! the number of times the buckets or slots were grown or rehashed. */
+    int64_t resizes;
+    /*! the total length of the stored keys. */
+    int64_t key_bytes;
+    /*! the live bytes in the @ref arena_t: whole entries, key data
+     * included, for a chained @ref map_t, or inline key data for a flat one. */
+    int64_t entry_bytes;
+    /*! the bytes allocated for buckets, or slots and control bytes. */
+    int64_t table_bytes;
+    /*! the heap bytes held by the @ref map_t, including arena chunks. */
+    int64_t bytes;
+} map_stats_t;
+
+/**
+ * @brief map_fn is a callback function type for use with @ref map_foreach.
+ * 
+ * @relates map_t
+ * 
+ * @param key the key of the key-value pair, owned by the @ref map_t.
+ * @param value the value of the key-value pair.
+ * @param ctx the context pointer passed to @ref map_foreach.
+ */
+typedef void(map_fn)(string_t* key, void* value, void* ctx);
+
+/**
+ * @brief map_update_fn is a callback function type for use with
+ * @ref map_update.
+ * 
+ * @relates map_t
+ * 
+ * @param value the current value, or NULL if the key was just inserted.
+ * @param ctx the context pointer passed to @ref map_update.
+ * 
+ * @return void* the new value.
+ */
+typedef void*(map_update_fn)(void* value, void* ctx);
+
 /**
  * @brief map_new returns a new @ref map_t instance.
  * 
  * map_new returns a new @ref map_t instance with @p bucket_count buckets
- * with @p bucket_capacity initial capacity. 
+ * with @p bucket_capacity initial capacity. Buckets are only allocated once
+ * a key-value pair is stored in them.
+ * 
+ * Once the @ref map_t averages more than one key-value pair per bucket, it
+ * doubles its bucket count. Rather than rehashing every pair at once, each
+ * subsequent @ref map_set and @ref map_delete migrates a few of the old
+ * buckets until the resize completes. Lookups never migrate buckets, so
+ * they only read the @ref map_t and may run concurrently with each other.
  * 
  * @relates map_t
  * 
@@ -26,12 +215,35 @@ typedef struct map_t {
  */
 map_t* map_new(int64_t bucket_count, int64_t bucket_capacity);
 
+/**
+ * @brief map_new_flat returns a new flat @ref map_t instance.
+ * 
+ * map_new_flat returns a new @ref map_t instance using the
+ * @ref MAP_ENGINE_FLAT storage layout, with enough slots for storing
+ * @p capacity key-value pairs before growing. The slot array doubles in
+ * size whenever it becomes 7/8 full, rehashing every pair in one step.
+ * 
+ * @relates map_t
+ * 
+ * @param capacity the number of key-value pairs to reserve space for.
+ * 
+ * @return map_t* a new @ref map_t instance.
+ */
+map_t* map_new_flat(int64_t capacity);
+
 /**
  * @brief map_copy returns a copy of @p self.
  * 
  * map_copy returns a new @ref map_t containing the same key-value 
  * pairs as @p self. @p bucket_count and @p bucket_capacity are used for
- * creating the new @ref map_t.
+ * creating the new @ref map_t. The copy uses the same storage layout as
+ * @p self; a flat copy has the same slot layout as @p self and ignores
+ * @p bucket_count and @p bucket_capacity.
+ * 
+ * When @p bucket_count matches the bucket count of @p self, or @p self is
+ * flat, the buckets or slots of @p self are cloned directly without
+ * rehashing or comparing any key. A chained @p self that is still growing
+ * finishes migrating its buckets first.
  * 
  * @relates map_t
  * 
@@ -77,6 +289,103 @@ map_t* map_clear(map_t* self);
  */
 map_t* map_set(map_t* self, string_t* key, void* value);
 
+/**
+ * @brief map_set_hashed adds a key-value pair using a precomputed hash.
+ * 
+ * map_set_hashed behaves like @ref map_set, but uses @p hash instead of
+ * hashing @p key. @p hash must equal @ref string_hash of @p key.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key for the key-value pair.
+ * @param hash the hash of @p key.
+ * @param value the value for the key-value pair.
+ * 
+ * @return map_t* @p self.
+ */
+map_t* map_set_hashed(map_t* self, string_t* key, uint64_t hash, void* value);
+
+/**
+ * @brief map_set_take adds a key-value pair, adopting @p key instead of
+ * copying it.
+ * 
+ * map_set_take behaves like @ref map_set, but the @ref map_t takes
+ * ownership of @p key, which must have been returned by @ref string or
+ * @ref string_copy. The key data is stored without copying and freed by the
+ * map once the key-value pair is removed. If @p key already matches a
+ * key-value pair, its value is replaced and @p key is freed at once.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key for the key-value pair, owned by @p self afterwards.
+ * @param value the value for the key-value pair.
+ * 
+ * @return map_t* @p self.
+ */
+map_t* map_set_take(map_t* self, string_t* key, void* value);
+
+/**
+ * @brief map_set_borrowed adds a key-value pair, referencing the data of
+ * @p key instead of copying it.
+ * 
+ * map_set_borrowed behaves like @ref map_set, but the key data is neither
+ * copied nor freed by the @ref map_t. The caller guarantees that the data
+ * of @p key, such as an interned or static string, outlives the key-value
+ * pair and is not modified.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key for the key-value pair.
+ * @param value the value for the key-value pair.
+ * 
+ * @return map_t* @p self.
+ */
+map_t* map_set_borrowed(map_t* self, string_t* key, void* value);
+
+/**
+ * @brief map_get_or_insert returns a pointer to the value matching
+ * @p key, inserting a NULL value first if no match was found.
+ * 
+ * map_get_or_insert hashes @p key once and probes the @ref map_t once, so
+ * reading and then writing the value through the returned pointer replaces
+ * a @ref map_get followed by a @ref map_set. Chained entries never move,
+ * so the pointer stays valid until the pair is removed.
+ * 
+ * A flat @ref map_t grows before inserting, then moves its slots whenever
+ * it grows again, so the pointer into a flat @ref map_t is only valid until
+ * the next insertion into @p self.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key to lookup, copied if inserted.
+ * @param inserted set to true if @p key was inserted, else false.
+ * 
+ * @return void** a pointer to the value matching @p key.
+ */
+void** map_get_or_insert(map_t* self, string_t* key, bool* inserted);
+
+/**
+ * @brief map_update replaces the value matching @p key with the result of
+ * @p fn, inserting @p key first if no match was found.
+ * 
+ * map_update hashes @p key once and probes the @ref map_t once. @p fn is
+ * passed the current value, or NULL for an inserted key.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key to update, copied if inserted.
+ * @param fn the function returning the new value.
+ * @param ctx a context pointer passed to every call of @p fn.
+ * 
+ * @return void* the new value.
+ */
+void* map_update(map_t* self, string_t* key, map_update_fn fn, void* ctx);
+
 
 /**
  * @brief map_equal returns true if two @ref map_t instances are equal.
@@ -110,6 +419,42 @@ bool map_equal(map_t* lhs, map_t* rhs);
  */
 void* map_delete(map_t* self, string_t* key);
 
+/**
+ * @brief map_delete_take removes the key-value pair matching @p key and
+ * hands its stored key to the caller.
+ * 
+ * map_delete_take behaves like @ref map_delete, but sets @p stored_key to
+ * the removed key instead of freeing it, or to NULL if @p key matches no
+ * key-value pair. A key adopted by @ref map_set_take is returned without
+ * copying its data; other keys are returned as a copy.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key to search for deletion.
+ * @param stored_key set to the removed key, owned by the caller.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* map_delete_take(map_t* self, string_t* key, string_t** stored_key);
+
+/**
+ * @brief map_delete_bytes removes the key-value pair whose key is held in
+ * @p length bytes of @p data.
+ * 
+ * map_delete_bytes behaves like @ref map_delete, but hashes and compares
+ * the key in place.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param data the key data to search for deletion.
+ * @param length the length of the key data.
+ * 
+ * @return void* the value matching the key if found, else NULL.
+ */
+void* map_delete_bytes(map_t* self, char const* data, int64_t length);
+
 /**
  * @brief map_get returns the key-value pair matching the given @p key,
  * else NULL if no match was found.
@@ -122,3 +467,157 @@ void* map_delete(map_t* self, string_t* key);
  * @return void* the value matching @p key if found, else NULL.
  */
 void* map_get(map_t* self, string_t* key);
+
+/**
+ * @brief map_get_bytes returns the value matching the key held in
+ * @p length bytes of @p data, else NULL if no match was found.
+ * 
+ * map_get_bytes behaves like @ref map_get, but hashes and compares the
+ * key in place, so a key inside a larger buffer needs no @ref string_t.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param data the key data to lookup.
+ * @param length the length of the key data.
+ * 
+ * @return void* the value matching the key if found, else NULL.
+ */
+void* map_get_bytes(map_t* self, char const* data, int64_t length);
+
+/**
+ * @brief map_contains_bytes returns true if @p self holds the key held in
+ * @p length bytes of @p data.
+ * 
+ * Unlike @ref map_get_bytes, map_contains_bytes tells a key stored with a
+ * NULL value apart from a missing key.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param data the key data to lookup.
+ * @param length the length of the key data.
+ * 
+ * @return bool true if the key was found, else false.
+ */
+bool map_contains_bytes(map_t* self, char const* data, int64_t length);
+
+/**
+ * @brief map_get_hashed returns the value matching @p key using a
+ * precomputed hash, else NULL if no match was found.
+ * 
+ * map_get_hashed behaves like @ref map_get, but uses @p hash instead of
+ * hashing @p key. @p hash must equal @ref string_hash of @p key.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param key the key to lookup.
+ * @param hash the hash of @p key.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* map_get_hashed(map_t* self, string_t* key, uint64_t hash);
+
+/**
+ * @brief map_get_many looks up @p count keys at once.
+ * 
+ * map_get_many stores the value matching each key in @p keys at the same
+ * index of @p out, or NULL if no match was found. Keys are hashed and their
+ * buckets or slots are prefetched in batches before any key is resolved,
+ * so the cache misses of many lookups overlap instead of being paid one
+ * after another as with repeated calls to @ref map_get.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param keys the keys to lookup.
+ * @param count the number of keys in @p keys.
+ * @param out the array of at least @p count values to store results in.
+ */
+void map_get_many(map_t* self, string_t** keys, int64_t count, void** out);
+
+/**
+ * @brief map_size returns the number of key-value pairs in @p self.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * 
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t map_size(map_t* self);
+
+/**
+ * @brief map_stats fills @p stats with the layout and memory use of
+ * @p self.
+ * 
+ * map_stats visits every bucket or slot, so it takes O(n) time and is
+ * meant for occasional monitoring rather than hot paths.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param stats the @ref map_stats_t to fill.
+ */
+void map_stats(map_t* self, map_stats_t* stats);
+
+/**
+ * @brief map_iter returns a @ref map_iter_t positioned before the first
+ * key-value pair of @p self.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * 
+ * @return map_iter_t a new @ref map_iter_t over @p self.
+ */
+map_iter_t map_iter(map_t* self);
+
+/**
+ * @brief map_iter_next advances @p iter to the next key-value pair.
+ * 
+ * map_iter_next advances @p iter, setting its key and value to the next
+ * key-value pair in unspecified order.
+ * 
+ * @relates map_iter_t
+ * 
+ * @param iter the @ref map_iter_t instance.
+ * 
+ * @return bool true if @p iter points at a key-value pair, else false once
+ * every pair has been visited.
+ */
+bool map_iter_next(map_iter_t* iter);
+
+/**
+ * @brief map_foreach calls a function with each key-value pair in a
+ * @ref map_t.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param fn the function to call.
+ * @param ctx the context pointer passed to each call of @p fn.
+ */
+void map_foreach(map_t* self, map_fn fn, void* ctx);
+
+/**
+ * @brief map_foreach_parallel calls a function with each key-value pair in
+ * a @ref map_t, using the threads of @ref thread_pool_default.
+ * 
+ * The buckets, or slots of a flat @ref map_t, are split into chunks of
+ * @p grain buckets, which the threads claim and steal from one another
+ * until every pair was visited, in no particular order. Buckets still
+ * being migrated are walked like any other bucket. @p fn is called from
+ * several threads at once, and @p self must not be modified until the call
+ * returns; lookups are read-only and may run alongside it.
+ * 
+ * @relates map_t
+ * 
+ * @param self the @ref map_t instance.
+ * @param fn the function to call.
+ * @param ctx the context pointer passed to each call of @p fn.
+ * @param grain the number of buckets or slots in each chunk, or 0 to pick
+ * one from the number of buckets and threads.
+ */
+void map_foreach_parallel(map_t* self, map_fn fn, void* ctx, int64_t grain);
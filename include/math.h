@@ -8,4 +8,26 @@
 int64_t crumb_max(int64_t, int64_t);
 int64_t crumb_min(int64_t, int64_t);
 
+/**
+ * @brief crumb_mix64 scrambles the bits of @p x, so that nearby integers
+ * hash far apart.
+ * 
+ * crumb_mix64 is the SplitMix64 finalizer, a bijection taking a handful of
+ * multiplies and shifts. It is defined in this header so hash lookups can
+ * inline it.
+ * 
+ * @param x the integer to scramble.
+ * 
+ * @return uint64_t the scrambled integer.
+ */
+static inline uint64_t crumb_mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ULL;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+
+    return x;
+}
+
 #endif
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+/*! MMAP_MAP_MAGIC identifies a file written by @ref map_save. */
+#define MMAP_MAP_MAGIC 0x50414D424D555243ULL
+/*! MMAP_MAP_VERSION is the version of the file layout. */
+#define MMAP_MAP_VERSION 1
+
+/**
+ * @brief mmap_map_header_t is the header at the start of a file written by
+ * @ref map_save.
+ *
+ * Every section is addressed by its offset from the start of the file, so
+ * the file can be mapped at any address.
+ */
+typedef struct mmap_map_header_t {
+    /*! the file magic, @ref MMAP_MAP_MAGIC in native byte order. */
+    uint64_t magic;
+    /*! the file layout version. */
+    uint32_t version;
+    /*! reserved, written as zero. */
+    uint32_t reserved;
+    /*! the XXH64 seed used for hashing keys. */
+    uint64_t seed;
+    /*! the number of key-value pairs. */
+    int64_t size;
+    /*! the number of pilots. */
+    int64_t bucket_count;
+    /*! the offset of the pilots. */
+    int64_t pilots_offset;
+    /*! the offset of the slots. */
+    int64_t slots_offset;
+    /*! the offset of the key-value data. */
+    int64_t data_offset;
+    /*! the length of the key-value data. */
+    int64_t data_length;
+} mmap_map_header_t;
+
+/**
+ * @brief mmap_map_slot_t is the on-disk slot of one key-value pair.
+ */
+typedef struct mmap_map_slot_t {
+    /*! the hash of the key. */
+    uint64_t hash;
+    /*! the offset of the key data, followed by the value data. */
+    int64_t offset;
+    /*! the length of the key data. */
+    int64_t key_length;
+} mmap_map_slot_t;
+
+/**
+ * @brief mmap_map_t is a read-only hash map served from a file written by
+ * @ref map_save.
+ *
+ * The file holds the minimal perfect hash of a @ref frozen_map_t with each
+ * key stored next to its value. Lookups read the mapped pages directly and
+ * allocate nothing, and processes mapping the same file share its pages.
+ */
+typedef struct mmap_map_t {
+    /*! the mapped file. */
+    void* data;
+    /*! the length of the mapped file. */
+    int64_t length;
+    /*! pilots holds the displacement of each bucket. */
+    uint32_t const* pilots;
+    /*! slots holds one slot per key-value pair, followed by a sentinel. */
+    mmap_map_slot_t const* slots;
+    /*! blob holds the key-value data, in slot order. */
+    char const* blob;
+    /*! the number of key-value pairs. */
+    int64_t size;
+    /*! the number of buckets. */
+    int64_t bucket_count;
+    /*! the XXH64 seed used for hashing keys. */
+    uint64_t seed;
+} mmap_map_t;
+
+/**
+ * @brief map_save writes the key-value pairs of @p self to the file at
+ * @p path, in the format read by @ref map_open_mmap.
+ *
+ * The values of @p self must be @ref string_t instances, whose data is
+ * written next to their keys. The file is written under a temporary name
+ * in the same directory and then renamed over @p path, so processes that
+ * still map the previous file keep reading it safely. A replaced file keeps
+ * its permissions, while a new file is readable and writable by its owner
+ * only.
+ *
+ * @relates map_t
+ *
+ * @param self the @ref map_t instance.
+ * @param path the path of the file to write.
+ *
+ * @return bool true if the file was written, else false.
+ */
+bool map_save(map_t* self, char const* path);
+
+/**
+ * @brief map_open_mmap maps the file at @p path, written by @ref map_save,
+ * into memory.
+ *
+ * map_open_mmap checks the header and every slot before accepting the
+ * file, so a truncated or corrupt file is rejected rather than read out of
+ * bounds.
+ *
+ * @relates mmap_map_t
+ *
+ * @param path the path of the file to map.
+ *
+ * @return mmap_map_t* a new @ref mmap_map_t instance, or NULL if the file
+ * could not be mapped or was not written by @ref map_save.
+ */
+mmap_map_t* map_open_mmap(char const* path);
+
+/**
+ * @brief mmap_map_close unmaps the file of @p self and frees its memory.
+ *
+ * @relates mmap_map_t
+ *
+ * @param self the @ref mmap_map_t instance.
+ */
+void mmap_map_close(mmap_map_t* self);
+
+/**
+ * @brief mmap_map_get returns the value data matching the given @p key,
+ * else NULL if no match was found.
+ *
+ * The returned data points into the mapped file and stays valid until
+ * @ref mmap_map_close is called.
+ *
+ * @relates mmap_map_t
+ *
+ * @param self the @ref mmap_map_t instance.
+ * @param key the key to lookup.
+ * @param length set to the length of the value data if found.
+ *
+ * @return char const* the value data matching @p key if found, else NULL.
+ */
+char const* mmap_map_get(mmap_map_t* self, string_t* key, int64_t* length);
+
+/**
+ * @brief mmap_map_size returns the number of key-value pairs in @p self.
+ *
+ * @relates mmap_map_t
+ *
+ * @param self the @ref mmap_map_t instance.
+ *
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t mmap_map_size(mmap_map_t* self);
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+/**
+ * @brief PMAP_BITS is the number of hash bits consumed by each level of a
+ * @ref pmap_t.
+ */
+#define PMAP_BITS 5
+
+/**
+ * @brief pmap_kind_t is the kind of a @ref pmap_node_t.
+ */
+typedef enum pmap_kind_t {
+    /*! a @ref pmap_branch_t. */
+    PMAP_BRANCH,
+    /*! a @ref pmap_leaf_t. */
+    PMAP_LEAF,
+    /*! a @ref pmap_collision_t. */
+    PMAP_COLLISION,
+} pmap_kind_t;
+
+/**
+ * @brief pmap_node_t is the header shared by every node of a @ref pmap_t.
+ *
+ * Nodes are immutable once built and may be shared by many versions, so
+ * each node counts the versions and parent nodes referencing it.
+ */
+typedef struct pmap_node_t {
+    /*! the number of references to this node. */
+    _Atomic int64_t refs;
+    /*! the kind of this node. */
+    pmap_kind_t kind;
+} pmap_node_t;
+
+/**
+ * @brief pmap_branch_t is an inner node with one child per set bit of its
+ * bitmap.
+ */
+typedef struct pmap_branch_t {
+    /*! the node header. */
+    pmap_node_t node;
+    /*! bitmap has a bit set for each of the 32 hash chunks with a child. */
+    uint32_t bitmap;
+    /*! children holds one child per set bit, in bit order. */
+    pmap_node_t* children[];
+} pmap_branch_t;
+
+/**
+ * @brief pmap_leaf_t is a key-value pair, with the key data stored inline.
+ */
+typedef struct pmap_leaf_t {
+    /*! the node header. */
+    pmap_node_t node;
+    /*! the key and its hash, whose memory buffer points at @ref data. */
+    string_t key;
+    /*! the value. */
+    void* value;
+    /*! the key data. */
+    char data[];
+} pmap_leaf_t;
+
+/**
+ * @brief pmap_collision_t holds the leaves of distinct keys sharing one
+ * full 64 bit hash.
+ */
+typedef struct pmap_collision_t {
+    /*! the node header. */
+    pmap_node_t node;
+    /*! the hash shared by every leaf. */
+    uint64_t hash;
+    /*! the number of leaves. */
+    int64_t count;
+    /*! leaves holds the key-value pairs. */
+    pmap_leaf_t* leaves[];
+} pmap_collision_t;
+
+/**
+ * @brief pmap_t is one immutable version of a persistent hash map for
+ * looking up values with a @ref string_t key.
+ *
+ * pmap_t is a hash array mapped trie: each level of branches is indexed by
+ * the next @ref PMAP_BITS bits of a key's XXH64 hash, and branches only
+ * store the children that exist. @ref pmap_set and @ref pmap_delete never
+ * modify a version. They return a new one that copies the O(log n) nodes
+ * on the path to the key and shares every other node with the old one.
+ * Taking a snapshot with @ref pmap_snapshot only counts a new reference.
+ *
+ * Versions and nodes are reference counted atomically, so versions may be
+ * read, snapshotted and freed from any thread. Publishing a new version to
+ * other threads is left to the caller.
+ */
+typedef struct pmap_t {
+    /*! the number of references to this version. */
+    _Atomic int64_t refs;
+    /*! the root node, or NULL if empty. */
+    pmap_node_t* root;
+    /*! the number of key-value pairs. */
+    int64_t size;
+} pmap_t;
+
+/**
+ * @brief pmap_new returns a new, empty @ref pmap_t instance.
+ *
+ * @relates pmap_t
+ *
+ * @return pmap_t* a new @ref pmap_t instance.
+ */
+pmap_t* pmap_new(void);
+
+/**
+ * @brief pmap_snapshot returns another reference to @p self in O(1) time.
+ *
+ * Every reference must be released with @ref pmap_free.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ *
+ * @return pmap_t* @p self.
+ */
+pmap_t* pmap_snapshot(pmap_t* self);
+
+/**
+ * @brief pmap_free releases one reference to @p self, freeing the version
+ * and every node no other version shares once the last one is released.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ */
+void pmap_free(pmap_t* self);
+
+/**
+ * @brief pmap_set returns a new version of @p self in which @p key maps to
+ * @p value.
+ *
+ * @p self is not modified. The new version copies the nodes on the path to
+ * @p key and shares every other node with @p self.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ * @param key the key for the key-value pair, copied into the new version.
+ * @param value the value for the key-value pair.
+ *
+ * @return pmap_t* a new @ref pmap_t version.
+ */
+pmap_t* pmap_set(pmap_t* self, string_t* key, void* value);
+
+/**
+ * @brief pmap_delete returns a new version of @p self without @p key.
+ *
+ * @p self is not modified. If @p key is not found, a snapshot of @p self
+ * is returned.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ * @param key the key to search for deletion.
+ *
+ * @return pmap_t* a new @ref pmap_t version.
+ */
+pmap_t* pmap_delete(pmap_t* self, string_t* key);
+
+/**
+ * @brief pmap_get returns the value matching the given @p key, else NULL
+ * if no match was found.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ * @param key the key to lookup.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* pmap_get(pmap_t* self, string_t* key);
+
+/**
+ * @brief pmap_size returns the number of key-value pairs in @p self.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ *
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t pmap_size(pmap_t* self);
+
+/**
+ * @brief pmap_foreach calls @p fn with every key-value pair in @p self.
+ *
+ * @relates pmap_t
+ *
+ * @param self the @ref pmap_t instance.
+ * @param fn the function called with each key-value pair.
+ * @param ctx a context pointer passed to every call of @p fn.
+ */
+void pmap_foreach(pmap_t* self, map_fn fn, void* ctx);
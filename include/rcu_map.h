@@ -0,0 +1,193 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "cstrings.h"
+#include "list.h"
+
+/**
+ * @brief rcu_map_table_t is one published version of the buckets of a
+ * @ref rcu_map_t.
+ */
+typedef struct rcu_map_table_t {
+    /*! the number of buckets. */
+    int64_t bucket_count;
+    /*! buckets holds an immutable @ref list_t of key-value pairs, or NULL. */
+    _Atomic(list_t*)* buckets;
+} rcu_map_table_t;
+
+/**
+ * @brief rcu_map_reader_t is a reader thread registered with a
+ * @ref rcu_map_t.
+ */
+typedef struct rcu_map_reader_t {
+    /*! the writer epoch observed at this reader's last quiescent state. */
+    _Atomic uint64_t epoch;
+    /*! the next registered reader. */
+    struct rcu_map_reader_t* next;
+} rcu_map_reader_t;
+
+/**
+ * @brief rcu_map_retired_t is memory waiting for readers to move past it.
+ */
+typedef struct rcu_map_retired_t {
+    /*! the retired memory. */
+    void* ptr;
+    /*! the function that frees @ref ptr. */
+    void (*free_fn)(void*);
+    /*! the writer epoch at which @ref ptr was unpublished. */
+    uint64_t epoch;
+    /*! the next retired memory. */
+    struct rcu_map_retired_t* next;
+} rcu_map_retired_t;
+
+/**
+ * @brief rcu_map_t is a hash map for read-mostly data whose lookups take
+ * no lock and write no shared memory.
+ * 
+ * rcu_map_t never modifies published memory. A writer copies the bucket it
+ * changes, or every bucket when growing, and publishes the copy with an
+ * atomic store, so @ref rcu_map_get only follows atomic loads. Writers are
+ * serialized by a mutex.
+ * 
+ * Replaced buckets, pairs and keys are retired instead of freed. Readers
+ * register with @ref rcu_map_reader_register and periodically call
+ * @ref rcu_map_quiescent outside of any lookup, which records the current
+ * writer epoch. Retired memory is freed by @ref rcu_map_reclaim once every
+ * registered reader has passed a quiescent state after it was retired.
+ */
+typedef struct rcu_map_t {
+    /*! table is the currently published buckets. */
+    _Atomic(rcu_map_table_t*) table;
+    /*! epoch is incremented each time a writer retires memory. */
+    _Atomic uint64_t epoch;
+    /*! writer serializes writers, registration and reclamation. */
+    pthread_mutex_t writer;
+    /*! readers is the list of registered readers. */
+    rcu_map_reader_t* readers;
+    /*! retired is the list of memory waiting to be freed, newest first. */
+    rcu_map_retired_t* retired;
+    /*! the number of key-value pairs in the @ref rcu_map_t. */
+    int64_t size;
+} rcu_map_t;
+
+/**
+ * @brief rcu_map_new returns a new @ref rcu_map_t instance.
+ * 
+ * rcu_map_new returns a new @ref rcu_map_t instance with @p bucket_count
+ * buckets. The bucket count doubles once the map averages more than one
+ * key-value pair per bucket.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param bucket_count the initial number of buckets.
+ * 
+ * @return rcu_map_t* a new @ref rcu_map_t instance.
+ */
+rcu_map_t* rcu_map_new(int64_t bucket_count);
+
+/**
+ * @brief rcu_map_free frees the memory of @p self, including any retired
+ * memory.
+ * 
+ * rcu_map_free must not run concurrently with any other operation on
+ * @p self.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ */
+void rcu_map_free(rcu_map_t* self);
+
+/**
+ * @brief rcu_map_reader_register registers the calling thread as a reader.
+ * 
+ * A registered reader may call @ref rcu_map_get at any time, and must call
+ * @ref rcu_map_quiescent regularly so that retired memory can be freed.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * 
+ * @return rcu_map_reader_t* the new reader.
+ */
+rcu_map_reader_t* rcu_map_reader_register(rcu_map_t* self);
+
+/**
+ * @brief rcu_map_reader_unregister unregisters and frees @p reader.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * @param reader the reader returned by @ref rcu_map_reader_register.
+ */
+void rcu_map_reader_unregister(rcu_map_t* self, rcu_map_reader_t* reader);
+
+/**
+ * @brief rcu_map_quiescent reports that @p reader holds no keys or values
+ * returned by earlier lookups.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * @param reader the reader returned by @ref rcu_map_reader_register.
+ */
+void rcu_map_quiescent(rcu_map_t* self, rcu_map_reader_t* reader);
+
+/**
+ * @brief rcu_map_set adds a key-value pair to the @ref rcu_map_t instance.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * @param key the key for the key-value pair.
+ * @param value the value for the key-value pair.
+ * 
+ * @return rcu_map_t* @p self.
+ */
+rcu_map_t* rcu_map_set(rcu_map_t* self, string_t* key, void* value);
+
+/**
+ * @brief rcu_map_delete removes the key-value pair matching @p key.
+ * 
+ * rcu_map_delete removes the key-value pair matching @p key, returning the
+ * value if @p key matches a key-value pair, else NULL. Readers may still
+ * observe the value until they pass a quiescent state.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * @param key the key to search for deletion.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* rcu_map_delete(rcu_map_t* self, string_t* key);
+
+/**
+ * @brief rcu_map_get returns the value matching the given @p key, else NULL
+ * if no match was found.
+ * 
+ * rcu_map_get takes no lock and may run concurrently with writers. It
+ * never writes to @p key, so readers may share one key object.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * @param key the key to lookup.
+ * 
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* rcu_map_get(rcu_map_t* self, string_t* key);
+
+/**
+ * @brief rcu_map_reclaim frees retired memory that no reader can observe.
+ * 
+ * @relates rcu_map_t
+ * 
+ * @param self the @ref rcu_map_t instance.
+ * 
+ * @return int64_t the number of retired allocations still waiting on readers.
+ */
+int64_t rcu_map_reclaim(rcu_map_t* self);
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "cstrings.h"
+
+/**
+ * @brief set_t is a hash set of @ref string_t keys.
+ *
+ * set_t stores each key inline in one contiguous, linearly probed array of
+ * slots, holding the key's length, cached hash and a pointer to its data,
+ * with no value beside it. Key data is copied into an @ref arena_t owned by
+ * the set_t. Probes compare cached hashes before touching any key data,
+ * and removals shift later keys back instead of leaving tombstones.
+ */
+typedef struct set_t {
+    /*! slots holds the keys, where an empty slot has a NULL buffer. */
+    string_t* slots;
+    /*! the number of slots, always a power of two. */
+    int64_t capacity;
+    /*! the number of keys. */
+    int64_t size;
+    /*! arena holds the key data. */
+    arena_t* arena;
+} set_t;
+
+/**
+ * @brief set_iter_t is a cursor over the keys of a @ref set_t.
+ *
+ * The @ref set_t must not be modified until the walk is finished.
+ */
+typedef struct set_iter_t {
+    /*! the @ref set_t being walked. */
+    set_t* set;
+    /*! the current slot. */
+    int64_t slot;
+    /*! the current key, owned by the @ref set_t. */
+    string_t* key;
+} set_iter_t;
+
+/**
+ * @brief set_new returns a new @ref set_t instance.
+ *
+ * @relates set_t
+ *
+ * @param capacity the number of keys to make room for.
+ *
+ * @return set_t* a new @ref set_t instance.
+ */
+set_t* set_new(int64_t capacity);
+
+/**
+ * @brief set_copy returns a copy of @p self.
+ *
+ * The slots of @p self are cloned without rehashing or comparing any key.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ *
+ * @return set_t* a copy of @p self.
+ */
+set_t* set_copy(set_t* self);
+
+/**
+ * @brief set_free frees the memory of @p self.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ */
+void set_free(set_t* self);
+
+/**
+ * @brief set_clear removes every key from @p self.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ *
+ * @return set_t* @p self.
+ */
+set_t* set_clear(set_t* self);
+
+/**
+ * @brief set_add adds a copy of @p key to @p self.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ * @param key the key to add.
+ *
+ * @return bool true if @p key was added, else false if already present.
+ */
+bool set_add(set_t* self, string_t* key);
+
+/**
+ * @brief set_contains returns true if @p self holds @p key.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ * @param key the key to lookup.
+ *
+ * @return bool true if @p key was found, else false.
+ */
+bool set_contains(set_t* self, string_t* key);
+
+/**
+ * @brief set_remove removes @p key from @p self.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ * @param key the key to remove.
+ *
+ * @return bool true if @p key was found and removed, else false.
+ */
+bool set_remove(set_t* self, string_t* key);
+
+/**
+ * @brief set_size returns the number of keys in @p self.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ *
+ * @return int64_t the number of keys in @p self.
+ */
+int64_t set_size(set_t* self);
+
+/**
+ * @brief set_union returns a new @ref set_t holding the keys found in
+ * @p lhs, @p rhs or both.
+ *
+ * set_union copies the larger set and adds the keys of the smaller one,
+ * reusing their cached hashes.
+ *
+ * @relates set_t
+ *
+ * @param lhs the @ref set_t on the left side of the operation.
+ * @param rhs the @ref set_t on the right side of the operation.
+ *
+ * @return set_t* a new @ref set_t instance.
+ */
+set_t* set_union(set_t* lhs, set_t* rhs);
+
+/**
+ * @brief set_intersect returns a new @ref set_t holding the keys found in
+ * both @p lhs and @p rhs.
+ *
+ * set_intersect probes the larger set with each key of the smaller one.
+ *
+ * @relates set_t
+ *
+ * @param lhs the @ref set_t on the left side of the operation.
+ * @param rhs the @ref set_t on the right side of the operation.
+ *
+ * @return set_t* a new @ref set_t instance.
+ */
+set_t* set_intersect(set_t* lhs, set_t* rhs);
+
+/**
+ * @brief set_difference returns a new @ref set_t holding the keys found in
+ * @p lhs but not in @p rhs.
+ *
+ * If @p lhs is the smaller set, each of its keys probes @p rhs. Otherwise
+ * @p lhs is copied and each key of @p rhs is removed from the copy.
+ *
+ * @relates set_t
+ *
+ * @param lhs the @ref set_t on the left side of the operation.
+ * @param rhs the @ref set_t on the right side of the operation.
+ *
+ * @return set_t* a new @ref set_t instance.
+ */
+set_t* set_difference(set_t* lhs, set_t* rhs);
+
+/**
+ * @brief set_iter returns a @ref set_iter_t positioned before the first
+ * key of @p self.
+ *
+ * @relates set_t
+ *
+ * @param self the @ref set_t instance.
+ *
+ * @return set_iter_t a cursor over the keys of @p self.
+ */
+set_iter_t set_iter(set_t* self);
+
+/**
+ * @brief set_iter_next advances @p iter to the next key.
+ *
+ * @relates set_iter_t
+ *
+ * @param iter the @ref set_iter_t instance.
+ *
+ * @return bool true if @p iter points at a key, else false once every key
+ * was visited.
+ */
+bool set_iter_next(set_iter_t* iter);
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "arena.h"
+#include "cstrings.h"
+
+/**
+ * @brief string_intern_t is an atom table holding one canonical
+ * @ref string_t per distinct string.
+ *
+ * Interning the same data always returns the same @ref string_t, so two
+ * interned strings are equal exactly when their pointers are equal, and
+ * @ref string_equal and @ref list_find compare them without reading their
+ * data. Each interned string keeps its hash precomputed. Interned strings
+ * are owned by the table, live until it is freed, and must not be passed
+ * to @ref string_free.
+ */
+typedef struct string_intern_t {
+    /*! slots holds the interned strings, or NULL for an empty slot. */
+    string_t** slots;
+    /*! the number of slots, always a power of two. */
+    int64_t capacity;
+    /*! the number of interned strings. */
+    int64_t size;
+    /*! arena holds every interned string and its data. */
+    arena_t* arena;
+} string_intern_t;
+
+/**
+ * @brief string_intern_new returns a new @ref string_intern_t instance.
+ *
+ * @relates string_intern_t
+ *
+ * @param capacity the number of strings to make room for.
+ *
+ * @return string_intern_t* a new @ref string_intern_t instance.
+ */
+string_intern_t* string_intern_new(int64_t capacity);
+
+/**
+ * @brief string_intern_free frees the memory of @p self and of every
+ * string it interned.
+ *
+ * @relates string_intern_t
+ *
+ * @param self the @ref string_intern_t instance.
+ */
+void string_intern_free(string_intern_t* self);
+
+/**
+ * @brief string_intern returns the canonical @ref string_t holding
+ * @p length characters of @p str, interning a copy if none exists yet.
+ *
+ * @relates string_intern_t
+ *
+ * @param self the @ref string_intern_t instance.
+ * @param str the raw string data to intern.
+ * @param length the length of the string.
+ *
+ * @return string_t* the canonical @ref string_t owned by @p self.
+ */
+string_t* string_intern(string_intern_t* self, char const* str, int64_t length);
+
+/**
+ * @brief string_intern_string returns the canonical @ref string_t equal to
+ * @p str, interning a copy if none exists yet.
+ *
+ * The hash cached in @p str is reused, and returned unchanged if @p str is
+ * already the canonical instance.
+ *
+ * @relates string_intern_t
+ *
+ * @param self the @ref string_intern_t instance.
+ * @param str the @ref string_t to intern.
+ *
+ * @return string_t* the canonical @ref string_t owned by @p self.
+ */
+string_t* string_intern_string(string_intern_t* self, string_t* str);
+
+/**
+ * @brief string_intern_size returns the number of strings in @p self.
+ *
+ * @relates string_intern_t
+ *
+ * @param self the @ref string_intern_t instance.
+ *
+ * @return int64_t the number of strings in @p self.
+ */
+int64_t string_intern_size(string_intern_t* self);
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief thread_pool_range_fn is a callback function type for use with
+ * @ref thread_pool_for.
+ *
+ * @relates thread_pool_t
+ *
+ * @param start the first index of the chunk.
+ * @param end the index past the last index of the chunk.
+ * @param ctx the context pointer passed to @ref thread_pool_for.
+ */
+typedef void(thread_pool_range_fn)(int64_t start, int64_t end, void* ctx);
+
+/**
+ * @brief thread_pool_job_t is a parallel loop being run by a
+ * @ref thread_pool_t.
+ */
+typedef struct thread_pool_job_t thread_pool_job_t;
+
+/**
+ * @brief thread_pool_t is a fixed set of worker threads for running
+ * parallel loops.
+ *
+ * @ref thread_pool_for splits a loop into chunks and deals each
+ * participating thread, the calling thread included, one contiguous range
+ * of chunks. A thread claims chunks from the front of its own range, and
+ * once it runs out, steals the remaining chunks of the other ranges, so
+ * uneven chunks still keep every thread busy. Claiming a chunk is a single
+ * atomic increment. Workers sleep on a condition variable between loops.
+ */
+typedef struct thread_pool_t {
+    /*! threads holds the worker threads. */
+    pthread_t* threads;
+    /*! the number of worker threads. */
+    int64_t thread_count;
+    /*! lock guards every field below. */
+    pthread_mutex_t lock;
+    /*! wake is signalled when a job is posted or the pool stops. */
+    pthread_cond_t wake;
+    /*! done is signalled when the last worker finishes a job. */
+    pthread_cond_t done;
+    /*! submit serializes the loops run by different threads. */
+    pthread_mutex_t submit;
+    /*! the job being run, or NULL. */
+    thread_pool_job_t* job;
+    /*! the number of jobs posted so far. */
+    uint64_t generation;
+    /*! the number of workers still running the job. */
+    int64_t busy;
+    /*! true once the workers must exit. */
+    bool stop;
+} thread_pool_t;
+
+/**
+ * @brief thread_pool_new returns a new @ref thread_pool_t instance.
+ *
+ * The calling thread of @ref thread_pool_for runs chunks too, so the pool
+ * starts one worker fewer than @p thread_count.
+ *
+ * @relates thread_pool_t
+ *
+ * @param thread_count the number of threads running each loop, or 0 for
+ * one per online CPU.
+ *
+ * @return thread_pool_t* a new @ref thread_pool_t instance.
+ */
+thread_pool_t* thread_pool_new(int64_t thread_count);
+
+/**
+ * @brief thread_pool_free stops the workers of @p self and frees its
+ * memory.
+ *
+ * @relates thread_pool_t
+ *
+ * @param self the @ref thread_pool_t instance.
+ */
+void thread_pool_free(thread_pool_t* self);
+
+/**
+ * @brief thread_pool_default returns the pool shared by the parallel
+ * functions of this library, with one thread per online CPU.
+ *
+ * The pool is started on first use and lives until the process exits.
+ *
+ * @relates thread_pool_t
+ *
+ * @return thread_pool_t* the shared @ref thread_pool_t instance.
+ */
+thread_pool_t* thread_pool_default(void);
+
+/**
+ * @brief thread_pool_size returns the number of threads running each loop
+ * of @p self, the calling thread included.
+ *
+ * @relates thread_pool_t
+ *
+ * @param self the @ref thread_pool_t instance.
+ *
+ * @return int64_t the number of threads running each loop.
+ */
+int64_t thread_pool_size(thread_pool_t* self);
+
+/**
+ * @brief thread_pool_for calls @p fn with chunks of @p grain indices
+ * covering [0, @p size), in parallel, and returns once every call is done.
+ *
+ * @p fn is called from several threads at once. A call made from inside
+ * @p fn runs its chunks on the calling thread instead of deadlocking.
+ *
+ * @relates thread_pool_t
+ *
+ * @param self the @ref thread_pool_t instance.
+ * @param size the number of indices.
+ * @param grain the number of indices in each chunk, at least 1.
+ * @param fn the function called with each chunk.
+ * @param ctx a context pointer passed to every call of @p fn.
+ */
+void thread_pool_for(thread_pool_t* self, int64_t size, int64_t grain, thread_pool_range_fn fn, void* ctx);
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief CRUMB_LIST_MIN_CAPACITY is the capacity a typed list grows to
+ * from an empty memory buffer.
+ */
+#define CRUMB_LIST_MIN_CAPACITY 8
+
+/**
+ * @brief CRUMB_LIST_EQUAL_VALUE compares the elements at @p lhs and @p rhs
+ * with ==, for arithmetic element types.
+ */
+#define CRUMB_LIST_EQUAL_VALUE(lhs, rhs) (*(lhs) == *(rhs))
+
+/**
+ * @brief CRUMB_LIST_EQUAL_BYTES compares the elements at @p lhs and
+ * @p rhs bytewise, for struct element types without padding.
+ */
+#define CRUMB_LIST_EQUAL_BYTES(lhs, rhs) (memcmp((lhs), (rhs), sizeof(*(lhs))) == 0)
+
+/**
+ * @brief CRUMB_DECLARE_LIST declares a dynamic array named @p name storing
+ * elements of type @p T inline.
+ *
+ * @ref list_t stores void pointers, so a list of numbers or small structs
+ * needs one allocation per element and a pointer chase per read. The
+ * generated `name_t` stores its elements contiguously in a `T* buf`
+ * instead, and every function is `static inline`, so callers in hot loops
+ * compile down to plain array accesses.
+ *
+ * The generated functions mirror @ref list_t:
+ * - `name_t* name_new(int64_t capacity)`
+ * - `name_t* name_copy(name_t* self)`
+ * - `void name_free(name_t* self)`
+ * - `name_t* name_append(name_t* self, T value)`
+ * - `name_t* name_clear(name_t* self)`
+ * - `name_t* name_extend(name_t* self, name_t* other)`
+ * - `name_t* name_prepend(name_t* self, T value)`
+ * - `name_t* name_resize(name_t* self, int64_t capacity)`
+ * - `name_t* name_reserve(name_t* self, int64_t size)`, growing
+ *   geometrically until @p size elements fit
+ * - `name_t* name_slice(name_t* self, int64_t start, int64_t end)`
+ * - `bool name_equal(name_t* lhs, name_t* rhs)`
+ * - `int64_t name_capacity(name_t* self)`
+ * - `int64_t name_find(name_t* self, T value)`
+ * - `int64_t name_size(name_t* self)`
+ * - `T* name_get(name_t* self, int64_t index)`
+ * - `bool name_insert(name_t* self, int64_t index, T value)`
+ * - `bool name_pop(name_t* self, int64_t index, T* out)`
+ * - `bool name_set(name_t* self, int64_t index, T value)`
+ * - `void name_foreach(name_t* self, void (*fn)(T* elem))`
+ *
+ * Since elements are not pointers, @c name_get returns a pointer to the
+ * element, or NULL if out of bounds, and @c name_pop, @c name_insert and
+ * @c name_set report out of bounds indices by returning false. Elements
+ * are compared by @p equal in @c name_equal and @c name_find, so a list of
+ * doubles finds 0.0 for -0.0 but never finds NaN, as with ==.
+ *
+ * @param name the prefix of the generated type and functions.
+ * @param T the element type.
+ * @param equal a function or macro called as `equal(T const* lhs, T const*
+ * rhs)`, returning true if the two elements are equal, such as
+ * @ref CRUMB_LIST_EQUAL_VALUE or @ref CRUMB_LIST_EQUAL_BYTES.
+ */
+#define CRUMB_DECLARE_LIST(name, T, equal) \
+    typedef struct name##_t { \
+        T* buf; \
+        int64_t capacity; \
+        int64_t size; \
+    } name##_t; \
+    \
+    static inline name##_t* name##_new(int64_t capacity) { \
+        name##_t* self = malloc(sizeof(name##_t)); \
+        capacity = capacity > 1 ? capacity : 1; \
+        self->buf = malloc(sizeof(T) * capacity); \
+        self->capacity = capacity; \
+        self->size = 0; \
+        return self; \
+    } \
+    \
+    static inline void name##_free(name##_t* self) { \
+        free(self->buf); \
+        free(self); \
+    } \
+    \
+    static inline name##_t* name##_resize(name##_t* self, int64_t capacity) { \
+        if (capacity > self->capacity) { \
+            self->buf = realloc(self->buf, sizeof(T) * capacity); \
+            self->capacity = capacity; \
+        } \
+        return self; \
+    } \
+    \
+    static inline name##_t* name##_reserve(name##_t* self, int64_t size) { \
+        if (size > self->capacity) { \
+            int64_t capacity = size > self->capacity * 2 ? size : self->capacity * 2; \
+            name##_resize(self, capacity > CRUMB_LIST_MIN_CAPACITY ? capacity : CRUMB_LIST_MIN_CAPACITY); \
+        } \
+        return self; \
+    } \
+    \
+    static inline name##_t* name##_copy(name##_t* self) { \
+        name##_t* other = name##_new(self->capacity); \
+        memcpy(other->buf, self->buf, sizeof(T) * self->size); \
+        other->size = self->size; \
+        return other; \
+    } \
+    \
+    static inline name##_t* name##_append(name##_t* self, T value) { \
+        name##_reserve(self, self->size + 1); \
+        self->buf[self->size++] = value; \
+        return self; \
+    } \
+    \
+    static inline name##_t* name##_clear(name##_t* self) { \
+        self->size = 0; \
+        return self; \
+    } \
+    \
+    static inline name##_t* name##_extend(name##_t* self, name##_t* other) { \
+        name##_reserve(self, self->size + other->size); \
+        memcpy(self->buf + self->size, other->buf, sizeof(T) * other->size); \
+        self->size += other->size; \
+        return self; \
+    } \
+    \
+    static inline name##_t* name##_prepend(name##_t* self, T value) { \
+        name##_reserve(self, self->size + 1); \
+        memmove(self->buf + 1, self->buf, sizeof(T) * self->size); \
+        self->buf[0] = value; \
+        ++self->size; \
+        return self; \
+    } \
+    \
+    static inline name##_t* name##_slice(name##_t* self, int64_t start, int64_t end) { \
+        if (start < 0 || start > end || end > self->size) { \
+            return NULL; \
+        } \
+        name##_t* slice = name##_new(end - start); \
+        memcpy(slice->buf, self->buf + start, sizeof(T) * (end - start)); \
+        slice->size = end - start; \
+        return slice; \
+    } \
+    \
+    static inline bool name##_equal(name##_t* lhs, name##_t* rhs) { \
+        if (lhs == rhs) { \
+            return true; \
+        } \
+        if (lhs->size != rhs->size) { \
+            return false; \
+        } \
+        for (int64_t n = 0; n < lhs->size; ++n) { \
+            if (!equal(&lhs->buf[n], &rhs->buf[n])) { \
+                return false; \
+            } \
+        } \
+        return true; \
+    } \
+    \
+    static inline int64_t name##_capacity(name##_t* self) { \
+        return self->capacity; \
+    } \
+    \
+    static inline int64_t name##_find(name##_t* self, T value) { \
+        for (int64_t n = 0; n < self->size; ++n) { \
+            if (equal(&self->buf[n], &value)) { \
+                return n; \
+            } \
+        } \
+        return -1; \
+    } \
+    \
+    static inline int64_t name##_size(name##_t* self) { \
+        return self->size; \
+    } \
+    \
+    static inline T* name##_get(name##_t* self, int64_t index) { \
+        return index >= 0 && index < self->size ? &self->buf[index] : NULL; \
+    } \
+    \
+    static inline bool name##_insert(name##_t* self, int64_t index, T value) { \
+        if (index < 0 || index > self->size) { \
+            return false; \
+        } \
+        name##_reserve(self, self->size + 1); \
+        memmove(self->buf + index + 1, self->buf + index, sizeof(T) * (self->size - index)); \
+        self->buf[index] = value; \
+        ++self->size; \
+        return true; \
+    } \
+    \
+    static inline bool name##_pop(name##_t* self, int64_t index, T* out) { \
+        if (index < 0 || index >= self->size) { \
+            return false; \
+        } \
+        if (out != NULL) { \
+            *out = self->buf[index]; \
+        } \
+        memmove(self->buf + index, self->buf + index + 1, sizeof(T) * (self->size - index - 1)); \
+        --self->size; \
+        return true; \
+    } \
+    \
+    static inline bool name##_set(name##_t* self, int64_t index, T value) { \
+        if (index < 0 || index >= self->size) { \
+            return false; \
+        } \
+        self->buf[index] = value; \
+        return true; \
+    } \
+    \
+    static inline void name##_foreach(name##_t* self, void (*fn)(T* elem)) { \
+        for (int64_t n = 0; n < self->size; ++n) { \
+            fn(&self->buf[n]); \
+        } \
+    }
+
+/**
+ * @brief i64list_t is a list of int64_t values stored inline.
+ */
+CRUMB_DECLARE_LIST(i64list, int64_t, CRUMB_LIST_EQUAL_VALUE)
+
+/**
+ * @brief f64list_t is a list of double values stored inline.
+ */
+CRUMB_DECLARE_LIST(f64list, double, CRUMB_LIST_EQUAL_VALUE)
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief u64map_slot_t is a key-value pair stored inline by a
+ * @ref u64map_t.
+ */
+typedef struct u64map_slot_t {
+    /*! the key, or 0 for an empty slot. */
+    uint64_t key;
+    /*! the value. */
+    void* value;
+} u64map_slot_t;
+
+/**
+ * @brief u64map_t is a hash map for looking up values with a uint64_t key.
+ *
+ * u64map_t stores its key-value pairs inline in one contiguous, linearly
+ * probed array of slots, so storing a pair allocates nothing until the
+ * array grows. Keys are hashed with @ref crumb_mix64 rather than a string
+ * hash. Removals shift later pairs back instead of leaving tombstones. The
+ * key 0 marks an empty slot, so its pair is stored beside the slots.
+ */
+typedef struct u64map_t {
+    /*! slots holds the key-value pairs with a non-zero key. */
+    u64map_slot_t* slots;
+    /*! the number of slots, always a power of two. */
+    int64_t capacity;
+    /*! the number of key-value pairs, including the zero key. */
+    int64_t size;
+    /*! true if the zero key is stored. */
+    bool has_zero;
+    /*! the value of the zero key. */
+    void* zero_value;
+} u64map_t;
+
+/**
+ * @brief u64map_new returns a new @ref u64map_t instance.
+ *
+ * @relates u64map_t
+ *
+ * @param capacity the number of key-value pairs to make room for.
+ *
+ * @return u64map_t* a new @ref u64map_t instance.
+ */
+u64map_t* u64map_new(int64_t capacity);
+
+/**
+ * @brief u64map_free frees the memory of @p self.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ */
+void u64map_free(u64map_t* self);
+
+/**
+ * @brief u64map_clear removes every key-value pair from @p self.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ *
+ * @return u64map_t* @p self.
+ */
+u64map_t* u64map_clear(u64map_t* self);
+
+/**
+ * @brief u64map_set adds a key-value pair to @p self, replacing the value
+ * of @p key if present.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ * @param key the key for the key-value pair.
+ * @param value the value for the key-value pair.
+ *
+ * @return u64map_t* @p self.
+ */
+u64map_t* u64map_set(u64map_t* self, uint64_t key, void* value);
+
+/**
+ * @brief u64map_get returns the value matching @p key, else NULL if no
+ * match was found.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ * @param key the key to lookup.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* u64map_get(u64map_t* self, uint64_t key);
+
+/**
+ * @brief u64map_contains returns true if @p self holds @p key.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ * @param key the key to lookup.
+ *
+ * @return bool true if @p key was found, else false.
+ */
+bool u64map_contains(u64map_t* self, uint64_t key);
+
+/**
+ * @brief u64map_delete removes the key-value pair matching @p key.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ * @param key the key to search for deletion.
+ *
+ * @return void* the value matching @p key if found, else NULL.
+ */
+void* u64map_delete(u64map_t* self, uint64_t key);
+
+/**
+ * @brief u64map_size returns the number of key-value pairs in @p self.
+ *
+ * @relates u64map_t
+ *
+ * @param self the @ref u64map_t instance.
+ *
+ * @return int64_t the number of key-value pairs in @p self.
+ */
+int64_t u64map_size(u64map_t* self);
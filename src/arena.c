@@ -0,0 +1,136 @@
+#include "arena.h"
+
+#include <stdlib.h>
+
+#include "list.h"
+
+#define ARENA_MAX_CLASS_SIZE (ARENA_SIZE_CLASSES * ARENA_ALIGNMENT)
+
+int64_t arena_size_class(int64_t size) {
+    return size <= ARENA_ALIGNMENT ? 0 : (size - 1) / ARENA_ALIGNMENT;
+}
+
+void list_foreach_arena_chunk_free_fn(void* elem) {
+    free(elem);
+}
+
+void arena_free_large(arena_t* self) {
+    while (self->large != NULL) {
+        arena_block_t* block = self->large;
+        self->large = block->next;
+
+        free(block);
+    }
+}
+
+arena_t* arena_new(int64_t chunk_size) {
+    arena_t* self = malloc(sizeof(arena_t));
+    self->chunks = list_new(8);
+    self->cursor = NULL;
+    self->remaining = 0;
+    self->chunk_size = chunk_size > ARENA_MAX_CLASS_SIZE ? chunk_size : ARENA_MAX_CLASS_SIZE;
+    self->chunk_size += (ARENA_ALIGNMENT - self->chunk_size % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+    self->large = NULL;
+    self->bytes = 0;
+
+    for (int64_t n = 0; n < ARENA_SIZE_CLASSES; ++n) {
+        self->free_lists[n] = NULL;
+    }
+
+    return self;
+}
+
+void arena_free(arena_t* self) {
+    arena_free_large(self);
+    list_foreach(self->chunks, list_foreach_arena_chunk_free_fn);
+    list_free(self->chunks);
+    free(self);
+}
+
+arena_t* arena_clear(arena_t* self) {
+    arena_free_large(self);
+
+    while (list_size(self->chunks) > 1) {
+        free(list_pop(self->chunks, list_size(self->chunks) - 1));
+    }
+
+    self->cursor = list_get(self->chunks, 0);
+    self->remaining = self->cursor != NULL ? self->chunk_size : 0;
+    self->bytes = 0;
+
+    for (int64_t n = 0; n < ARENA_SIZE_CLASSES; ++n) {
+        self->free_lists[n] = NULL;
+    }
+
+    return self;
+}
+
+void* arena_alloc(arena_t* self, int64_t size) {
+    self->bytes += size;
+
+    if (size > ARENA_MAX_CLASS_SIZE) {
+        arena_block_t* block = malloc(sizeof(arena_block_t) + size);
+        block->prev = NULL;
+        block->next = self->large;
+
+        if (self->large != NULL) {
+            self->large->prev = block;
+        }
+        self->large = block;
+
+        return block + 1;
+    }
+
+    int64_t size_class = arena_size_class(size);
+    void* block = self->free_lists[size_class];
+
+    if (block != NULL) {
+        self->free_lists[size_class] = *(void**) block;
+
+        return block;
+    }
+
+    int64_t class_size = (size_class + 1) * ARENA_ALIGNMENT;
+
+    if (self->remaining < class_size) {
+        // the tail of the old chunk is too small for this class, and is never
+        // handed out afterwards, even to smaller classes, so each chunk wastes
+        // less than ARENA_MAX_CLASS_SIZE bytes.
+        self->cursor = aligned_alloc(ARENA_ALIGNMENT, self->chunk_size);
+        self->remaining = self->chunk_size;
+        self->chunks = list_append(self->chunks, self->cursor);
+    }
+
+    block = self->cursor;
+    self->cursor += class_size;
+    self->remaining -= class_size;
+
+    return block;
+}
+
+void arena_release(arena_t* self, void* ptr, int64_t size) {
+    self->bytes -= size;
+
+    if (size > ARENA_MAX_CLASS_SIZE) {
+        arena_block_t* block = (arena_block_t*) ptr - 1;
+
+        if (block->prev != NULL) {
+            block->prev->next = block->next;
+        } else {
+            self->large = block->next;
+        }
+
+        if (block->next != NULL) {
+            block->next->prev = block->prev;
+        }
+
+        free(block);
+
+        return;
+    }
+
+    int64_t size_class = arena_size_class(size);
+
+    *(void**) ptr = self->free_lists[size_class];
+    self->free_lists[size_class] = ptr;
+}
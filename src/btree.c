@@ -0,0 +1,379 @@
+#include "btree.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "cstrings.h"
+#include "math.h"
+
+#define BTREE_ARENA_CHUNK_SIZE 65536
+
+// nodes are never merged, but the root only splits once full, so 64 levels
+// would take far more keys than fit in memory.
+#define BTREE_MAX_DEPTH 64
+
+typedef struct btree_path_t {
+    btree_node_t* node;
+    int32_t index;
+} btree_path_t;
+
+uint64_t btree_key_prefix(string_t const* key) {
+    uint64_t prefix = 0;
+
+    // shorter keys are zero padded, which keeps prefixes in key order.
+    for (int64_t n = 0; n < 8; ++n) {
+        prefix = (prefix << 8) | (n < key->length ? (uint8_t) key->buf[n] : 0);
+    }
+
+    return prefix;
+}
+
+int btree_compare(uint64_t prefix, string_t const* key, btree_node_t const* node, int32_t index) {
+    if (prefix != node->prefixes[index]) {
+        return prefix < node->prefixes[index] ? -1 : 1;
+    }
+
+    return string_compare(key, &node->keys[index]);
+}
+
+// btree_lower_index returns the number of keys in node less than key.
+int32_t btree_lower_index(btree_node_t const* node, uint64_t prefix, string_t const* key) {
+    int32_t lo = 0;
+    int32_t hi = node->count;
+
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+
+        if (btree_compare(prefix, key, node, mid) > 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+// btree_upper_index returns the number of keys in node not greater than key.
+int32_t btree_upper_index(btree_node_t const* node, uint64_t prefix, string_t const* key) {
+    int32_t lo = 0;
+    int32_t hi = node->count;
+
+    while (lo < hi) {
+        int32_t mid = (lo + hi) / 2;
+
+        if (btree_compare(prefix, key, node, mid) >= 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+btree_node_t* btree_node_new(bool leaf) {
+    btree_node_t* node = malloc(sizeof(btree_node_t));
+
+    node->leaf = leaf;
+    node->count = 0;
+    node->prev = NULL;
+    node->next = NULL;
+
+    return node;
+}
+
+void btree_node_free(btree_node_t* node) {
+    if (!node->leaf) {
+        for (int32_t n = 0; n <= node->count; ++n) {
+            btree_node_free(node->children[n]);
+        }
+    }
+
+    free(node);
+}
+
+string_t btree_key_copy(btree_t* self, string_t const* key) {
+    string_t copy = *key;
+
+    copy.buf = arena_alloc(self->arena, crumb_max(key->length, 1));
+    memcpy(copy.buf, key->buf, key->length);
+
+    return copy;
+}
+
+void btree_key_free(btree_t* self, string_t* key) {
+    arena_release(self->arena, key->buf, crumb_max(key->length, 1));
+}
+
+// btree_descend returns the leaf that holds or would hold key, recording the
+// inner nodes and child indices passed on the way if path is not NULL.
+btree_node_t* btree_descend(btree_t* self, uint64_t prefix, string_t const* key, btree_path_t* path, int32_t* depth) {
+    btree_node_t* node = self->root;
+
+    while (!node->leaf) {
+        int32_t index = btree_upper_index(node, prefix, key);
+
+        if (path != NULL) {
+            path[(*depth)++] = (btree_path_t) { .node = node, .index = index };
+        }
+
+        node = node->children[index];
+    }
+
+    return node;
+}
+
+// btree_split splits every full node from node up to the root, inserting
+// each new separator into the parent recorded in path.
+void btree_split(btree_t* self, btree_node_t* node, btree_path_t* path, int32_t depth) {
+    while (node->count == BTREE_ORDER) {
+        int32_t mid = BTREE_ORDER / 2;
+        btree_node_t* right = btree_node_new(node->leaf);
+        string_t separator;
+        uint64_t separator_prefix;
+
+        if (node->leaf) {
+            right->count = BTREE_ORDER - mid;
+            memcpy(right->prefixes, node->prefixes + mid, sizeof(uint64_t) * right->count);
+            memcpy(right->keys, node->keys + mid, sizeof(string_t) * right->count);
+            memcpy(right->values, node->values + mid, sizeof(void*) * right->count);
+
+            // the separator outlives the key it copies, which may be deleted.
+            separator = btree_key_copy(self, &right->keys[0]);
+            separator_prefix = right->prefixes[0];
+
+            right->prev = node;
+            right->next = node->next;
+            if (node->next != NULL) {
+                node->next->prev = right;
+            }
+            node->next = right;
+        } else {
+            right->count = BTREE_ORDER - mid - 1;
+            memcpy(right->prefixes, node->prefixes + mid + 1, sizeof(uint64_t) * right->count);
+            memcpy(right->keys, node->keys + mid + 1, sizeof(string_t) * right->count);
+            memcpy(right->children, node->children + mid + 1, sizeof(btree_node_t*) * (right->count + 1));
+
+            separator = node->keys[mid];
+            separator_prefix = node->prefixes[mid];
+        }
+        node->count = mid;
+
+        if (depth == 0) {
+            btree_node_t* root = btree_node_new(false);
+
+            root->count = 1;
+            root->prefixes[0] = separator_prefix;
+            root->keys[0] = separator;
+            root->children[0] = node;
+            root->children[1] = right;
+            self->root = root;
+
+            return;
+        }
+
+        btree_node_t* parent = path[--depth].node;
+        int32_t index = path[depth].index;
+
+        memmove(parent->prefixes + index + 1, parent->prefixes + index, sizeof(uint64_t) * (parent->count - index));
+        memmove(parent->keys + index + 1, parent->keys + index, sizeof(string_t) * (parent->count - index));
+        memmove(parent->children + index + 2, parent->children + index + 1, sizeof(btree_node_t*) * (parent->count - index));
+        parent->prefixes[index] = separator_prefix;
+        parent->keys[index] = separator;
+        parent->children[index + 1] = right;
+        ++parent->count;
+
+        node = parent;
+    }
+}
+
+btree_t* btree_new(void) {
+    btree_t* self = malloc(sizeof(btree_t));
+
+    self->root = btree_node_new(true);
+    self->size = 0;
+    self->arena = arena_new(BTREE_ARENA_CHUNK_SIZE);
+
+    return self;
+}
+
+void btree_free(btree_t* self) {
+    btree_node_free(self->root);
+    arena_free(self->arena);
+    free(self);
+}
+
+btree_t* btree_set(btree_t* self, string_t* key, void* value) {
+    btree_path_t path[BTREE_MAX_DEPTH];
+    int32_t depth = 0;
+    uint64_t prefix = btree_key_prefix(key);
+    btree_node_t* leaf = btree_descend(self, prefix, key, path, &depth);
+    int32_t index = btree_lower_index(leaf, prefix, key);
+
+    if (index < leaf->count && btree_compare(prefix, key, leaf, index) == 0) {
+        leaf->values[index] = value;
+
+        return self;
+    }
+
+    memmove(leaf->prefixes + index + 1, leaf->prefixes + index, sizeof(uint64_t) * (leaf->count - index));
+    memmove(leaf->keys + index + 1, leaf->keys + index, sizeof(string_t) * (leaf->count - index));
+    memmove(leaf->values + index + 1, leaf->values + index, sizeof(void*) * (leaf->count - index));
+    leaf->prefixes[index] = prefix;
+    leaf->keys[index] = btree_key_copy(self, key);
+    leaf->values[index] = value;
+    ++leaf->count;
+    ++self->size;
+
+    btree_split(self, leaf, path, depth);
+
+    return self;
+}
+
+void* btree_get(btree_t* self, string_t* key) {
+    uint64_t prefix = btree_key_prefix(key);
+    btree_node_t* leaf = btree_descend(self, prefix, key, NULL, NULL);
+    int32_t index = btree_lower_index(leaf, prefix, key);
+
+    if (index < leaf->count && btree_compare(prefix, key, leaf, index) == 0) {
+        return leaf->values[index];
+    }
+
+    return NULL;
+}
+
+void* btree_delete(btree_t* self, string_t* key) {
+    btree_path_t path[BTREE_MAX_DEPTH];
+    int32_t depth = 0;
+    uint64_t prefix = btree_key_prefix(key);
+    btree_node_t* node = btree_descend(self, prefix, key, path, &depth);
+    int32_t index = btree_lower_index(node, prefix, key);
+
+    if (index >= node->count || btree_compare(prefix, key, node, index) != 0) {
+        return NULL;
+    }
+
+    void* value = node->values[index];
+
+    btree_key_free(self, &node->keys[index]);
+    memmove(node->prefixes + index, node->prefixes + index + 1, sizeof(uint64_t) * (node->count - index - 1));
+    memmove(node->keys + index, node->keys + index + 1, sizeof(string_t) * (node->count - index - 1));
+    memmove(node->values + index, node->values + index + 1, sizeof(void*) * (node->count - index - 1));
+    --node->count;
+    --self->size;
+
+    // free emptied nodes upwards; an inner node is empty once its only child is.
+    bool empty = node->count == 0;
+    while (empty && depth > 0) {
+        if (node->prev != NULL) {
+            node->prev->next = node->next;
+        }
+        if (node->next != NULL) {
+            node->next->prev = node->prev;
+        }
+        free(node);
+
+        node = path[--depth].node;
+        index = path[depth].index;
+
+        if (node->count == 0) {
+            continue;
+        }
+
+        // drop the separator bounding the removed child, on its left if any.
+        int32_t separator = index > 0 ? index - 1 : 0;
+
+        btree_key_free(self, &node->keys[separator]);
+        memmove(node->prefixes + separator, node->prefixes + separator + 1, sizeof(uint64_t) * (node->count - separator - 1));
+        memmove(node->keys + separator, node->keys + separator + 1, sizeof(string_t) * (node->count - separator - 1));
+        memmove(node->children + index, node->children + index + 1, sizeof(btree_node_t*) * (node->count - index));
+        --node->count;
+        empty = false;
+    }
+
+    if (empty && !node->leaf) {
+        free(node);
+        self->root = btree_node_new(true);
+    }
+
+    while (!self->root->leaf && self->root->count == 0) {
+        btree_node_t* root = self->root;
+
+        self->root = root->children[0];
+        free(root);
+    }
+
+    return value;
+}
+
+int64_t btree_size(btree_t* self) {
+    return self->size;
+}
+
+btree_iter_t btree_iter(btree_t* self) {
+    btree_node_t* node = self->root;
+
+    while (!node->leaf) {
+        node = node->children[0];
+    }
+
+    btree_iter_t iter = {
+        .leaf = node,
+        .index = -1,
+        .prefix = NULL,
+        .key = NULL,
+        .value = NULL,
+    };
+
+    return iter;
+}
+
+btree_iter_t btree_lower_bound(btree_t* self, string_t* key) {
+    uint64_t prefix = btree_key_prefix(key);
+    btree_node_t* leaf = btree_descend(self, prefix, key, NULL, NULL);
+
+    btree_iter_t iter = {
+        .leaf = leaf,
+        .index = btree_lower_index(leaf, prefix, key) - 1,
+        .prefix = NULL,
+        .key = NULL,
+        .value = NULL,
+    };
+
+    return iter;
+}
+
+btree_iter_t btree_prefix(btree_t* self, string_t* prefix) {
+    btree_iter_t iter = btree_lower_bound(self, prefix);
+    iter.prefix = prefix;
+
+    return iter;
+}
+
+bool btree_iter_next(btree_iter_t* iter) {
+    while (iter->leaf != NULL) {
+        if (++iter->index < iter->leaf->count) {
+            string_t* key = &iter->leaf->keys[iter->index];
+            string_t const* prefix = iter->prefix;
+
+            // keys starting with the prefix are contiguous, so the first miss ends the walk.
+            if (prefix != NULL && (key->length < prefix->length || memcmp(key->buf, prefix->buf, prefix->length) != 0)) {
+                iter->leaf = NULL;
+
+                return false;
+            }
+
+            iter->key = key;
+            iter->value = iter->leaf->values[iter->index];
+
+            return true;
+        }
+
+        iter->leaf = iter->leaf->next;
+        iter->index = -1;
+    }
+
+    return false;
+}
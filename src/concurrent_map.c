@@ -0,0 +1,112 @@
+#include "concurrent_map.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+concurrent_map_shard_t* concurrent_map_shard(concurrent_map_t* self, uint64_t hash) {
+    // the low hash bits pick slots inside each shard, so shards use the high bits.
+    if (self->shard_bits == 0) {
+        return self->shards;
+    }
+
+    return &self->shards[hash >> (64 - self->shard_bits)];
+}
+
+concurrent_map_t* concurrent_map_new(int64_t shard_count, int64_t shard_capacity) {
+    concurrent_map_t* self = malloc(sizeof(concurrent_map_t));
+    self->shard_count = 1;
+    self->shard_bits = 0;
+
+    while (self->shard_count < shard_count) {
+        self->shard_count *= 2;
+        ++self->shard_bits;
+    }
+
+    self->shards = aligned_alloc(alignof(concurrent_map_shard_t), sizeof(concurrent_map_shard_t) * self->shard_count);
+
+    for (int64_t n = 0; n < self->shard_count; ++n) {
+        pthread_rwlock_init(&self->shards[n].lock, NULL);
+        self->shards[n].map = map_new_flat(shard_capacity);
+    }
+
+    return self;
+}
+
+void concurrent_map_free(concurrent_map_t* self) {
+    for (int64_t n = 0; n < self->shard_count; ++n) {
+        pthread_rwlock_destroy(&self->shards[n].lock);
+        map_free(self->shards[n].map);
+    }
+
+    free(self->shards);
+    free(self);
+}
+
+concurrent_map_t* concurrent_map_clear(concurrent_map_t* self) {
+    for (int64_t n = 0; n < self->shard_count; ++n) {
+        pthread_rwlock_wrlock(&self->shards[n].lock);
+        map_clear(self->shards[n].map);
+        pthread_rwlock_unlock(&self->shards[n].lock);
+    }
+
+    return self;
+}
+
+// concurrent_map_key returns a view of @p key carrying its hash, so the
+// shard map never caches a hash into a key other threads may be reading.
+static inline string_t concurrent_map_key(string_t* key) {
+    string_t view = string_view(string_data(key), string_length(key));
+
+    view.hash = string_hash_uncached(key);
+
+    return view;
+}
+
+concurrent_map_t* concurrent_map_set(concurrent_map_t* self, string_t* key, void* value) {
+    string_t view = concurrent_map_key(key);
+    concurrent_map_shard_t* shard = concurrent_map_shard(self, view.hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    map_set_hashed(shard->map, &view, view.hash, value);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return self;
+}
+
+void* concurrent_map_delete(concurrent_map_t* self, string_t* key) {
+    string_t view = concurrent_map_key(key);
+    concurrent_map_shard_t* shard = concurrent_map_shard(self, view.hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    void* elem = map_delete(shard->map, &view);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return elem;
+}
+
+void* concurrent_map_get(concurrent_map_t* self, string_t* key) {
+    string_t view = concurrent_map_key(key);
+    concurrent_map_shard_t* shard = concurrent_map_shard(self, view.hash);
+
+    // lookups in a flat map_t never write to it, so readers can share the lock.
+    pthread_rwlock_rdlock(&shard->lock);
+    void* elem = map_get_hashed(shard->map, &view, view.hash);
+    pthread_rwlock_unlock(&shard->lock);
+
+    return elem;
+}
+
+int64_t concurrent_map_size(concurrent_map_t* self) {
+    int64_t size = 0;
+
+    for (int64_t n = 0; n < self->shard_count; ++n) {
+        pthread_rwlock_rdlock(&self->shards[n].lock);
+        size += map_size(self->shards[n].map);
+        pthread_rwlock_unlock(&self->shards[n].lock);
+    }
+
+    return size;
+}
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "xxhash.h"
+
 #include "math.h"
 
 string_t* string(char const* text, int64_t length) {
@@ -12,12 +14,26 @@ string_t* string(char const* text, int64_t length) {
 
     memcpy(self->buf, text, length);
     self->length = length;
+    self->hash = 0;
 
     return self;
 }
 
+string_t string_view(char const* text, int64_t length) {
+    string_t view = {
+        .buf = (char*) text,
+        .length = length,
+        .hash = 0,
+    };
+
+    return view;
+}
+
 string_t* string_copy(string_t const* self) {
-    return string(string_data(self), string_length(self));
+    string_t* other = string(string_data(self), string_length(self));
+    other->hash = self->hash;
+
+    return other;
 }
 
 void string_free(string_t* self) {
@@ -26,11 +42,29 @@ void string_free(string_t* self) {
 }
 
 bool string_equal(string_t const* lhs, string_t const* rhs) {
+    if (lhs == rhs) {
+        return true;
+    }
+
     if (string_length(lhs) != string_length(rhs)) {
         return false;
     }
 
-    return strncmp(string_data(lhs), string_data(rhs), string_length(lhs)) == 0;
+    if (lhs->hash != 0 && rhs->hash != 0 && lhs->hash != rhs->hash) {
+        return false;
+    }
+
+    return memcmp(string_data(lhs), string_data(rhs), string_length(lhs)) == 0;
+}
+
+int string_compare(string_t const* lhs, string_t const* rhs) {
+    int order = memcmp(string_data(lhs), string_data(rhs), crumb_min(string_length(lhs), string_length(rhs)));
+
+    if (order != 0) {
+        return order;
+    }
+
+    return (string_length(lhs) > string_length(rhs)) - (string_length(lhs) < string_length(rhs));
 }
 
 char* string_data(string_t const* self) {
@@ -52,3 +86,19 @@ string_t* string_substr(string_t const* self, int64_t start, int64_t end) {
 
     return string(string_data(self) + start, end - start + 1);
 }
+
+uint64_t string_hash(string_t* self) {
+    if (self->hash == 0) {
+        self->hash = XXH64(string_data(self), string_length(self), CRUMB_STRING_SEED);
+    }
+
+    return self->hash;
+}
+
+uint64_t string_hash_uncached(string_t const* self) {
+    if (self->hash != 0) {
+        return self->hash;
+    }
+
+    return XXH64(string_data(self), string_length(self), CRUMB_STRING_SEED);
+}
@@ -0,0 +1,138 @@
+#include "deque.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "math.h"
+
+#define DEQUE_MIN_CAPACITY 8
+
+static inline int64_t deque_position(deque_t const* self, int64_t index) {
+    return (self->head + index) & (self->capacity - 1);
+}
+
+// deque_grow doubles the buffer, unwrapping the elements so the first one
+// lands at position 0.
+void deque_grow(deque_t* self) {
+    void** buf = malloc(sizeof(void*) * self->capacity * 2);
+    int64_t first = crumb_min(self->size, self->capacity - self->head);
+
+    memcpy(buf, self->buf + self->head, sizeof(void*) * first);
+    memcpy(buf + first, self->buf, sizeof(void*) * (self->size - first));
+
+    free(self->buf);
+    self->buf = buf;
+    self->capacity *= 2;
+    self->head = 0;
+}
+
+deque_t* deque_new(int64_t capacity) {
+    deque_t* self = malloc(sizeof(deque_t));
+
+    self->capacity = DEQUE_MIN_CAPACITY;
+    while (self->capacity < capacity) {
+        self->capacity *= 2;
+    }
+
+    self->buf = malloc(sizeof(void*) * self->capacity);
+    self->head = 0;
+    self->size = 0;
+
+    return self;
+}
+
+void deque_free(deque_t* self) {
+    free(self->buf);
+    free(self);
+}
+
+deque_t* deque_clear(deque_t* self) {
+    self->head = 0;
+    self->size = 0;
+
+    return self;
+}
+
+deque_t* deque_push_back(deque_t* self, void* value) {
+    if (self->size == self->capacity) {
+        deque_grow(self);
+    }
+
+    self->buf[deque_position(self, self->size)] = value;
+    ++self->size;
+
+    return self;
+}
+
+deque_t* deque_push_front(deque_t* self, void* value) {
+    if (self->size == self->capacity) {
+        deque_grow(self);
+    }
+
+    self->head = deque_position(self, self->capacity - 1);
+    self->buf[self->head] = value;
+    ++self->size;
+
+    return self;
+}
+
+void* deque_pop_back(deque_t* self) {
+    if (self->size == 0) {
+        return NULL;
+    }
+
+    --self->size;
+
+    return self->buf[deque_position(self, self->size)];
+}
+
+void* deque_pop_front(deque_t* self) {
+    if (self->size == 0) {
+        return NULL;
+    }
+
+    void* value = self->buf[self->head];
+
+    self->head = deque_position(self, 1);
+    --self->size;
+
+    return value;
+}
+
+void* deque_get(deque_t* self, int64_t index) {
+    if (index >= self->size || index < 0) {
+        return NULL;
+    }
+
+    return self->buf[deque_position(self, index)];
+}
+
+void* deque_set(deque_t* self, int64_t index, void* value) {
+    if (index >= self->size || index < 0) {
+        return NULL;
+    }
+
+    self->buf[deque_position(self, index)] = value;
+
+    return value;
+}
+
+int64_t deque_size(deque_t* self) {
+    return self->size;
+}
+
+int64_t deque_capacity(deque_t* self) {
+    return self->capacity;
+}
+
+list_t* deque_to_list(deque_t* self) {
+    list_t* list = list_new(crumb_max(self->size, 1));
+    int64_t first = crumb_min(self->size, self->capacity - self->head);
+
+    memcpy(list->buf, self->buf + self->head, sizeof(void*) * first);
+    memcpy(list->buf + first, self->buf, sizeof(void*) * (self->size - first));
+    list->size = self->size;
+
+    return list;
+}
@@ -0,0 +1,227 @@
+#include "frozen_map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "xxhash.h"
+
+#include "cstrings.h"
+#include "map.h"
+#include "math.h"
+
+// keys per bucket; larger buckets mean fewer pilots but longer pilot searches.
+#define FROZEN_MAP_BUCKET_LOAD 4
+// the last buckets placed search among few free slots, so the pilot search
+// gives up after this many pilots, or 16 per key for large maps, and reseeds.
+#define FROZEN_MAP_PILOT_LIMIT (1 << 20)
+#define FROZEN_MAP_MAX_SEEDS 16
+
+uint64_t frozen_map_hash(uint64_t seed, string_t* key) {
+    // the default seed lets keys reuse the hash cached by string_hash.
+    if (seed == CRUMB_STRING_SEED) {
+        return string_hash(key);
+    }
+
+    return XXH64(string_data(key), string_length(key), seed);
+}
+
+int64_t frozen_map_position(uint64_t hash, uint64_t pilot, int64_t size) {
+    return crumb_mix64(hash ^ crumb_mix64(pilot + 1)) % size;
+}
+
+// frozen_map_bucket_collides reports whether two keys of a bucket share a
+// full hash, which no pilot can separate.
+bool frozen_map_bucket_collides(uint64_t* hashes, int64_t* keys, int64_t bucket_size) {
+    for (int64_t n = 0; n < bucket_size; ++n) {
+        for (int64_t m = n + 1; m < bucket_size; ++m) {
+            if (hashes[keys[n]] == hashes[keys[m]]) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool frozen_map_place(frozen_map_t* self, uint64_t* hashes, int64_t* order, int64_t* bucket_start, int64_t* positions, bool* taken) {
+    uint64_t pilot_limit = crumb_min(crumb_max(FROZEN_MAP_PILOT_LIMIT, self->size * 16), UINT32_MAX);
+    int64_t max_bucket_size = 0;
+
+    for (int64_t b = 0; b < self->bucket_count; ++b) {
+        max_bucket_size = crumb_max(max_bucket_size, bucket_start[b + 1] - bucket_start[b]);
+    }
+
+    // place the largest buckets first, while most slots are still free.
+    for (int64_t bucket_size = max_bucket_size; bucket_size > 0; --bucket_size) {
+        for (int64_t b = 0; b < self->bucket_count; ++b) {
+            if (bucket_start[b + 1] - bucket_start[b] != bucket_size) {
+                continue;
+            }
+
+            int64_t* keys = order + bucket_start[b];
+            uint64_t pilot = 0;
+
+            if (frozen_map_bucket_collides(hashes, keys, bucket_size)) {
+                return false;
+            }
+
+            for (; pilot < pilot_limit; ++pilot) {
+                int64_t placed = 0;
+
+                for (; placed < bucket_size; ++placed) {
+                    int64_t position = frozen_map_position(hashes[keys[placed]], pilot, self->size);
+
+                    if (taken[position]) {
+                        break;
+                    }
+
+                    taken[position] = true;
+                    positions[placed] = position;
+                }
+
+                if (placed == bucket_size) {
+                    break;
+                }
+
+                while (placed-- > 0) {
+                    taken[positions[placed]] = false;
+                }
+            }
+
+            if (pilot == pilot_limit) {
+                return false;
+            }
+
+            self->pilots[b] = (uint32_t) pilot;
+        }
+    }
+
+    return true;
+}
+
+frozen_map_t* map_freeze(map_t* self) {
+    frozen_map_t* frozen = malloc(sizeof(frozen_map_t));
+    int64_t size = self->size;
+
+    frozen->size = size;
+    frozen->bucket_count = crumb_max(1, (size + FROZEN_MAP_BUCKET_LOAD - 1) / FROZEN_MAP_BUCKET_LOAD);
+    frozen->pilots = calloc(frozen->bucket_count, sizeof(uint32_t));
+    frozen->slots = malloc(sizeof(frozen_map_slot_t) * (size + 1));
+    frozen->seed = CRUMB_STRING_SEED;
+
+    string_t** keys = malloc(sizeof(string_t*) * crumb_max(size, 1));
+    void** values = malloc(sizeof(void*) * crumb_max(size, 1));
+    uint64_t* hashes = malloc(sizeof(uint64_t) * crumb_max(size, 1));
+    int64_t* order = malloc(sizeof(int64_t) * crumb_max(size, 1));
+    int64_t* bucket_start = malloc(sizeof(int64_t) * (frozen->bucket_count + 2));
+    int64_t* positions = malloc(sizeof(int64_t) * crumb_max(size, 1));
+    bool* taken = malloc(sizeof(bool) * crumb_max(size, 1));
+    int64_t blob_size = 0;
+
+    int64_t count = 0;
+    for (map_iter_t iter = map_iter(self); map_iter_next(&iter); ++count) {
+        keys[count] = iter.key;
+        values[count] = iter.value;
+        blob_size += string_length(iter.key);
+    }
+
+    bool placed = size == 0;
+    for (int64_t attempt = 0; !placed && attempt < FROZEN_MAP_MAX_SEEDS; ++attempt) {
+        // a different seed helps if two keys share a full 64 bit hash, or a
+        // bucket ran out of pilots.
+        if (attempt > 0) {
+            frozen->seed = XXH64(&attempt, sizeof(attempt), CRUMB_STRING_SEED);
+        }
+
+        // counting sort the keys by bucket.
+        memset(bucket_start, 0, sizeof(int64_t) * (frozen->bucket_count + 2));
+        for (int64_t n = 0; n < size; ++n) {
+            hashes[n] = frozen_map_hash(frozen->seed, keys[n]);
+            ++bucket_start[hashes[n] % frozen->bucket_count + 2];
+        }
+        for (int64_t b = 0; b < frozen->bucket_count; ++b) {
+            bucket_start[b + 2] += bucket_start[b + 1];
+        }
+        for (int64_t n = 0; n < size; ++n) {
+            order[bucket_start[hashes[n] % frozen->bucket_count + 1]++] = n;
+        }
+
+        memset(taken, 0, sizeof(bool) * size);
+        placed = frozen_map_place(frozen, hashes, order, bucket_start, positions, taken);
+    }
+
+    if (!placed) {
+        free(frozen->pilots);
+        free(frozen->slots);
+        free(frozen);
+        frozen = NULL;
+        size = 0;
+    }
+
+    int64_t* slot_keys = positions;
+    for (int64_t n = 0; n < size; ++n) {
+        uint64_t hash = hashes[n];
+        int64_t position = frozen_map_position(hash, frozen->pilots[hash % frozen->bucket_count], size);
+
+        slot_keys[position] = n;
+    }
+
+    // pack the key data in slot order, so each key ends where the next slot's begins.
+    if (frozen != NULL) {
+        frozen->blob = malloc(sizeof(char) * crumb_max(blob_size, 1));
+
+        int64_t offset = 0;
+        for (int64_t position = 0; position < size; ++position) {
+            int64_t n = slot_keys[position];
+
+            frozen->slots[position].hash = hashes[n];
+            frozen->slots[position].offset = offset;
+            frozen->slots[position].value = values[n];
+
+            memcpy(frozen->blob + offset, string_data(keys[n]), string_length(keys[n]));
+            offset += string_length(keys[n]);
+        }
+        frozen->slots[size] = (frozen_map_slot_t) { .hash = 0, .offset = offset, .value = NULL };
+    }
+
+    free(keys);
+    free(values);
+    free(hashes);
+    free(order);
+    free(bucket_start);
+    free(positions);
+    free(taken);
+
+    return frozen;
+}
+
+void frozen_map_free(frozen_map_t* self) {
+    free(self->pilots);
+    free(self->slots);
+    free(self->blob);
+    free(self);
+}
+
+void* frozen_map_get(frozen_map_t* self, string_t* key) {
+    if (self->size == 0) {
+        return NULL;
+    }
+
+    uint64_t hash = frozen_map_hash(self->seed, key);
+    uint32_t pilot = self->pilots[hash % self->bucket_count];
+    frozen_map_slot_t* slot = &self->slots[frozen_map_position(hash, pilot, self->size)];
+
+    if (slot->hash != hash || slot[1].offset - slot->offset != string_length(key)) {
+        return NULL;
+    }
+
+    if (memcmp(self->blob + slot->offset, string_data(key), string_length(key)) != 0) {
+        return NULL;
+    }
+
+    return slot->value;
+}
+
+int64_t frozen_map_size(frozen_map_t* self) {
+    return self->size;
+}
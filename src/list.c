@@ -1,11 +1,163 @@
 #include "list.h"
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define LIST_FIND_X86 1
+#endif
+
+#include "cstrings.h"
 #include "math.h"
+#include "thread_pool.h"
+#include "typed_list.h"
+
+// ranges below this size are sorted by insertion.
+#define LIST_SORT_INSERTION_THRESHOLD 24
+// ranges above this size pick their pivot as a median of three medians.
+#define LIST_SORT_NINTHER_THRESHOLD 128
+// an already partitioned range is finished by insertion while it takes at
+// most this many moves.
+#define LIST_SORT_PARTIAL_INSERTION_LIMIT 8
+// each thread of list_sort_parallel sorts at least this many elements.
+#define LIST_SORT_PARALLEL_MIN_SIZE 65536
+// radix buckets below this size are sorted by insertion.
+#define LIST_RADIX_INSERTION_THRESHOLD 32
+// the parallel loops deal this many chunks per thread by default, leaving
+// spare chunks to steal when some take longer than others.
+#define LIST_PARALLEL_CHUNKS_PER_THREAD 8
+
+typedef int64_t(list_find_kernel)(void* const* buf, int64_t size, void* value);
+
+int64_t list_find_scalar(void* const* buf, int64_t size, void* value) {
+    for (int64_t n = 0; n < size; ++n) {
+        if (buf[n] == value) {
+            return n;
+        }
+    }
+
+    return -1;
+}
+
+#if defined(LIST_FIND_X86)
+// SSE2 has no 64 bit compare, so both 32 bit halves of a pointer must match.
+static inline int list_find_sse2_mask(__m128i elems, __m128i needle) {
+    __m128i eq = _mm_cmpeq_epi32(elems, needle);
+
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+
+    return _mm_movemask_pd(_mm_castsi128_pd(eq));
+}
+
+int64_t list_find_sse2(void* const* buf, int64_t size, void* value) {
+    __m128i needle = _mm_set1_epi64x((int64_t) (intptr_t) value);
+    int64_t n = 0;
+
+    for (; n + 8 <= size; n += 8) {
+        __m128i const* elems = (__m128i const*) (buf + n);
+        int masks[4] = {
+            list_find_sse2_mask(_mm_loadu_si128(elems), needle),
+            list_find_sse2_mask(_mm_loadu_si128(elems + 1), needle),
+            list_find_sse2_mask(_mm_loadu_si128(elems + 2), needle),
+            list_find_sse2_mask(_mm_loadu_si128(elems + 3), needle),
+        };
+        int mask = masks[0] | masks[1] << 2 | masks[2] << 4 | masks[3] << 6;
+
+        if (mask != 0) {
+            return n + __builtin_ctz(mask);
+        }
+    }
+
+    int64_t index = list_find_scalar(buf + n, size - n, value);
+
+    return index < 0 ? -1 : n + index;
+}
+
+__attribute__((target("avx2")))
+int64_t list_find_avx2(void* const* buf, int64_t size, void* value) {
+    __m256i needle = _mm256_set1_epi64x((int64_t) (intptr_t) value);
+    int64_t n = 0;
+
+    for (; n + 16 <= size; n += 16) {
+        __m256i const* elems = (__m256i const*) (buf + n);
+        __m256i eq0 = _mm256_cmpeq_epi64(_mm256_loadu_si256(elems), needle);
+        __m256i eq1 = _mm256_cmpeq_epi64(_mm256_loadu_si256(elems + 1), needle);
+        __m256i eq2 = _mm256_cmpeq_epi64(_mm256_loadu_si256(elems + 2), needle);
+        __m256i eq3 = _mm256_cmpeq_epi64(_mm256_loadu_si256(elems + 3), needle);
+
+        // test the four vectors at once, only building the index on a hit.
+        if (!_mm256_testz_si256(_mm256_or_si256(_mm256_or_si256(eq0, eq1), _mm256_or_si256(eq2, eq3)), _mm256_set1_epi8(-1))) {
+            int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq0))
+                | _mm256_movemask_pd(_mm256_castsi256_pd(eq1)) << 4
+                | _mm256_movemask_pd(_mm256_castsi256_pd(eq2)) << 8
+                | _mm256_movemask_pd(_mm256_castsi256_pd(eq3)) << 12;
+
+            return n + __builtin_ctz(mask);
+        }
+    }
+
+    int64_t index = list_find_sse2(buf + n, size - n, value);
+
+    return index < 0 ? -1 : n + index;
+}
+
+__attribute__((target("avx512f")))
+int64_t list_find_avx512(void* const* buf, int64_t size, void* value) {
+    __m512i needle = _mm512_set1_epi64((int64_t) (intptr_t) value);
+    int64_t n = 0;
+
+    for (; n + 32 <= size; n += 32) {
+        void* const* elems = buf + n;
+        uint32_t mask = _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(elems), needle)
+            | (uint32_t) _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(elems + 8), needle) << 8
+            | (uint32_t) _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(elems + 16), needle) << 16
+            | (uint32_t) _mm512_cmpeq_epi64_mask(_mm512_loadu_si512(elems + 24), needle) << 24;
+
+        if (mask != 0) {
+            return n + __builtin_ctz(mask);
+        }
+    }
+
+    int64_t index = list_find_avx2(buf + n, size - n, value);
+
+    return index < 0 ? -1 : n + index;
+}
+#endif
+
+list_find_kernel* list_find_select(void) {
+#if defined(LIST_FIND_X86)
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) {
+        return list_find_avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return list_find_avx2;
+    }
+
+    return list_find_sse2;
+#else
+    return list_find_scalar;
+#endif
+}
+
+// the kernel is picked on first use; racing threads store the same pointer.
+static _Atomic(list_find_kernel*) list_find_impl = NULL;
+
+static inline list_find_kernel* list_find_kernel_get(void) {
+    list_find_kernel* kernel = atomic_load_explicit(&list_find_impl, memory_order_relaxed);
+
+    if (kernel == NULL) {
+        kernel = list_find_select();
+        atomic_store_explicit(&list_find_impl, kernel, memory_order_relaxed);
+    }
+
+    return kernel;
+}
 
 list_t* list_new(int64_t capacity) {
     list_t* self = malloc(sizeof(list_t));
@@ -90,7 +242,7 @@ list_t* list_resize(list_t* self, int64_t capacity) {
     assert(capacity > self->capacity && capacity > self->size);
 
     self->capacity = capacity;
-    self->buf = realloc(self->buf, self->capacity);
+    self->buf = realloc(self->buf, sizeof(void*) * self->capacity);
 
     return self;
 }
@@ -122,13 +274,8 @@ bool list_equal(list_t* lhs, list_t* rhs) {
         return false;
     }
 
-    for (int64_t n = 0; n < lhs->size; n++) {
-        if (lhs->buf[n] != rhs->buf[n]) {
-            return false;
-        }
-    }
-
-    return true;
+    // memcmp is vectorized and dispatched by the C library already.
+    return lhs->size == 0 || memcmp(lhs->buf, rhs->buf, sizeof(void*) * lhs->size) == 0;
 }
 
 int64_t list_capacity(list_t* self) {
@@ -136,13 +283,19 @@ int64_t list_capacity(list_t* self) {
 }
 
 int64_t list_find(list_t* self, void* elem) {
-    for (int64_t n = 0; n < self->size; ++n) {
-        if (self->buf[n] == elem) {
-            return n;
-        }
+    return list_find_kernel_get()(self->buf, self->size, elem);
+}
+
+i64list_t* list_find_all(list_t* self, void* elem) {
+    list_find_kernel* kernel = list_find_kernel_get();
+    i64list_t* indices = i64list_new(0);
+
+    for (int64_t start = 0, index; (index = kernel(self->buf + start, self->size - start, elem)) >= 0;) {
+        i64list_append(indices, start + index);
+        start += index + 1;
     }
 
-    return -1;
+    return indices;
 }
 
 int64_t list_size(list_t* self) {
@@ -217,3 +370,587 @@ void list_foreach(list_t* self, void(fn)(void*)) {
         fn(self->buf[n]);
     }
 }
+
+int64_t list_parallel_grain(thread_pool_t* pool, int64_t size) {
+    return crumb_max(size / (thread_pool_size(pool) * LIST_PARALLEL_CHUNKS_PER_THREAD), 1);
+}
+
+typedef struct list_parallel_job_t {
+    list_t* list;
+    list_visit_fn* visit;
+    list_map_fn* map;
+    list_reduce_fn* reduce;
+    void* ctx;
+    int64_t grain;
+    void** partials;
+} list_parallel_job_t;
+
+void list_foreach_parallel_range(int64_t start, int64_t end, void* ctx) {
+    list_parallel_job_t* job = ctx;
+
+    for (int64_t n = start; n < end; ++n) {
+        job->visit(job->list->buf[n], job->ctx);
+    }
+}
+
+void list_foreach_parallel(list_t* self, list_visit_fn fn, void* ctx, int64_t grain) {
+    thread_pool_t* pool = thread_pool_default();
+    list_parallel_job_t job = { .list = self, .visit = fn, .ctx = ctx };
+
+    if (grain <= 0) {
+        grain = list_parallel_grain(pool, self->size);
+    }
+
+    thread_pool_for(pool, self->size, grain, list_foreach_parallel_range, &job);
+}
+
+void list_reduce_parallel_range(int64_t start, int64_t end, void* ctx) {
+    list_parallel_job_t* job = ctx;
+    void* result = job->map(job->list->buf[start], job->ctx);
+
+    for (int64_t n = start + 1; n < end; ++n) {
+        result = job->reduce(result, job->map(job->list->buf[n], job->ctx), job->ctx);
+    }
+
+    job->partials[start / job->grain] = result;
+}
+
+void* list_reduce_parallel(list_t* self, list_map_fn map, list_reduce_fn reduce, void* ctx) {
+    if (self->size == 0) {
+        return NULL;
+    }
+
+    thread_pool_t* pool = thread_pool_default();
+    int64_t grain = list_parallel_grain(pool, self->size);
+    int64_t chunks = (self->size + grain - 1) / grain;
+    list_parallel_job_t job = {
+        .list = self,
+        .map = map,
+        .reduce = reduce,
+        .ctx = ctx,
+        .grain = grain,
+        .partials = malloc(sizeof(void*) * chunks),
+    };
+
+    thread_pool_for(pool, self->size, grain, list_reduce_parallel_range, &job);
+
+    // chunk results are combined in list order, so reduce need not commute.
+    void* result = job.partials[0];
+    for (int64_t n = 1; n < chunks; ++n) {
+        result = reduce(result, job.partials[n], ctx);
+    }
+
+    free(job.partials);
+
+    return result;
+}
+
+static inline void list_swap(void** lhs, void** rhs) {
+    void* elem = *lhs;
+
+    *lhs = *rhs;
+    *rhs = elem;
+}
+
+static inline void list_sort3(void** a, void** b, void** c, list_compare_fn cmp, void* ctx) {
+    if (cmp(*b, *a, ctx) < 0) {
+        list_swap(a, b);
+    }
+    if (cmp(*c, *b, ctx) < 0) {
+        list_swap(b, c);
+
+        if (cmp(*b, *a, ctx) < 0) {
+            list_swap(a, b);
+        }
+    }
+}
+
+void list_insertion_sort(void** buf, int64_t size, list_compare_fn cmp, void* ctx) {
+    for (int64_t n = 1; n < size; ++n) {
+        void* elem = buf[n];
+        int64_t m = n;
+
+        for (; m > 0 && cmp(elem, buf[m - 1], ctx) < 0; --m) {
+            buf[m] = buf[m - 1];
+        }
+        buf[m] = elem;
+    }
+}
+
+// list_partial_insertion_sort gives up once more than
+// LIST_SORT_PARTIAL_INSERTION_LIMIT elements were moved, returning false.
+bool list_partial_insertion_sort(void** buf, int64_t size, list_compare_fn cmp, void* ctx) {
+    int64_t moves = 0;
+
+    for (int64_t n = 1; n < size; ++n) {
+        void* elem = buf[n];
+        int64_t m = n;
+
+        for (; m > 0 && cmp(elem, buf[m - 1], ctx) < 0; --m) {
+            buf[m] = buf[m - 1];
+        }
+        buf[m] = elem;
+
+        moves += n - m;
+        if (moves > LIST_SORT_PARTIAL_INSERTION_LIMIT) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void list_sift_down(void** buf, int64_t size, int64_t root, list_compare_fn cmp, void* ctx) {
+    for (int64_t child; (child = 2 * root + 1) < size; root = child) {
+        if (child + 1 < size && cmp(buf[child], buf[child + 1], ctx) < 0) {
+            ++child;
+        }
+        if (cmp(buf[root], buf[child], ctx) >= 0) {
+            return;
+        }
+
+        list_swap(&buf[root], &buf[child]);
+    }
+}
+
+void list_heap_sort(void** buf, int64_t size, list_compare_fn cmp, void* ctx) {
+    for (int64_t n = size / 2 - 1; n >= 0; --n) {
+        list_sift_down(buf, size, n, cmp, ctx);
+    }
+
+    for (int64_t n = size - 1; n > 0; --n) {
+        list_swap(&buf[0], &buf[n]);
+        list_sift_down(buf, n, 0, cmp, ctx);
+    }
+}
+
+// list_partition moves the elements less than the pivot in buf[0] to its
+// left, returning its final index. The pivot selection leaves an element
+// not less than the pivot at the end, which stops the first scan.
+int64_t list_partition(void** buf, int64_t size, list_compare_fn cmp, void* ctx, bool* partitioned) {
+    void* pivot = buf[0];
+    int64_t first = 0;
+    int64_t last = size;
+
+    while (cmp(buf[++first], pivot, ctx) < 0) {}
+
+    if (first == 1) {
+        while (first < last && cmp(buf[--last], pivot, ctx) >= 0) {}
+    } else {
+        while (cmp(buf[--last], pivot, ctx) >= 0) {}
+    }
+
+    *partitioned = first >= last;
+
+    while (first < last) {
+        list_swap(&buf[first], &buf[last]);
+
+        while (cmp(buf[++first], pivot, ctx) < 0) {}
+        while (cmp(buf[--last], pivot, ctx) >= 0) {}
+    }
+
+    buf[0] = buf[first - 1];
+    buf[first - 1] = pivot;
+
+    return first - 1;
+}
+
+// list_partition_equal moves the elements equal to the pivot in buf[0] to
+// its left, returning its final index. It is used once the pivot equals an
+// element before the range, which no element of the range is less than.
+int64_t list_partition_equal(void** buf, int64_t size, list_compare_fn cmp, void* ctx) {
+    void* pivot = buf[0];
+    int64_t first = 0;
+    int64_t last = size;
+
+    while (cmp(pivot, buf[--last], ctx) < 0) {}
+
+    if (last + 1 == size) {
+        while (first < last && cmp(pivot, buf[++first], ctx) >= 0) {}
+    } else {
+        while (cmp(pivot, buf[++first], ctx) >= 0) {}
+    }
+
+    while (first < last) {
+        list_swap(&buf[first], &buf[last]);
+
+        while (cmp(pivot, buf[--last], ctx) < 0) {}
+        while (cmp(pivot, buf[++first], ctx) >= 0) {}
+    }
+
+    buf[0] = buf[last];
+    buf[last] = pivot;
+
+    return last;
+}
+
+void list_pdqsort(void** buf, int64_t size, list_compare_fn cmp, void* ctx, int bad_allowed, bool leftmost) {
+    while (size >= LIST_SORT_INSERTION_THRESHOLD) {
+        int64_t half = size / 2;
+
+        if (size > LIST_SORT_NINTHER_THRESHOLD) {
+            list_sort3(buf, buf + half, buf + size - 1, cmp, ctx);
+            list_sort3(buf + 1, buf + half - 1, buf + size - 2, cmp, ctx);
+            list_sort3(buf + 2, buf + half + 1, buf + size - 3, cmp, ctx);
+            list_sort3(buf + half - 1, buf + half, buf + half + 1, cmp, ctx);
+            list_swap(buf, buf + half);
+        } else {
+            list_sort3(buf + half, buf, buf + size - 1, cmp, ctx);
+        }
+
+        // the element before this range is not greater than any element in
+        // it, so a pivot equal to it starts a run of equal elements.
+        if (!leftmost && cmp(buf[-1], buf[0], ctx) >= 0) {
+            int64_t pivot = list_partition_equal(buf, size, cmp, ctx);
+
+            buf += pivot + 1;
+            size -= pivot + 1;
+            continue;
+        }
+
+        bool partitioned;
+        int64_t pivot = list_partition(buf, size, cmp, ctx, &partitioned);
+        int64_t left = pivot;
+        int64_t right = size - pivot - 1;
+
+        if (left < size / 8 || right < size / 8) {
+            if (--bad_allowed == 0) {
+                list_heap_sort(buf, size, cmp, ctx);
+
+                return;
+            }
+
+            // swap a few elements to break the pattern behind the bad pivot.
+            if (left >= LIST_SORT_INSERTION_THRESHOLD) {
+                list_swap(buf, buf + left / 4);
+                list_swap(buf + pivot - 1, buf + pivot - left / 4);
+            }
+            if (right >= LIST_SORT_INSERTION_THRESHOLD) {
+                list_swap(buf + pivot + 1, buf + pivot + 1 + right / 4);
+                list_swap(buf + size - 1, buf + size - right / 4);
+            }
+        } else if (partitioned && list_partial_insertion_sort(buf, left, cmp, ctx)
+                && list_partial_insertion_sort(buf + pivot + 1, right, cmp, ctx)) {
+            return;
+        }
+
+        list_pdqsort(buf, left, cmp, ctx, bad_allowed, leftmost);
+        buf += pivot + 1;
+        size = right;
+        leftmost = false;
+    }
+
+    list_insertion_sort(buf, size, cmp, ctx);
+}
+
+void list_sort_range(void** buf, int64_t size, list_compare_fn cmp, void* ctx) {
+    int bad_allowed = 1;
+
+    for (int64_t n = size; n > 1; n /= 2) {
+        ++bad_allowed;
+    }
+
+    list_pdqsort(buf, size, cmp, ctx, bad_allowed, true);
+}
+
+list_t* list_sort(list_t* self, list_compare_fn cmp, void* ctx) {
+    list_sort_range(self->buf, self->size, cmp, ctx);
+
+    return self;
+}
+
+typedef struct list_sort_task_t {
+    /*! the source buffer. */
+    void** src;
+    /*! the destination buffer of a merge. */
+    void** dst;
+    /*! the start of the first range. */
+    int64_t start;
+    /*! the end of the first range, and start of the second. */
+    int64_t mid;
+    /*! the end of the second range. */
+    int64_t end;
+    /*! the first position of the merged range written by this task. */
+    int64_t from;
+    /*! the position after the last one written by this task. */
+    int64_t to;
+    /*! the function ordering two elements. */
+    list_compare_fn* cmp;
+    /*! the context pointer passed to cmp. */
+    void* ctx;
+} list_sort_task_t;
+
+void* list_sort_task_sort(void* arg) {
+    list_sort_task_t* task = arg;
+
+    list_sort_range(task->src + task->start, task->end - task->start, task->cmp, task->ctx);
+
+    return NULL;
+}
+
+// list_sort_co_rank returns how many of the first @p rank merged elements
+// come from the first range of @p task, taking from the left on ties.
+int64_t list_sort_co_rank(list_sort_task_t* task, int64_t rank) {
+    void** lhs = task->src + task->start;
+    void** rhs = task->src + task->mid;
+    int64_t lo = crumb_max(0, rank - (task->end - task->mid));
+    int64_t hi = crumb_min(rank, task->mid - task->start);
+
+    // lhs[i] precedes rhs[rank - i - 1] for every i below the co-rank.
+    while (lo < hi) {
+        int64_t i = lo + (hi - lo) / 2;
+
+        if (task->cmp(rhs[rank - i - 1], lhs[i], task->ctx) < 0) {
+            hi = i;
+        } else {
+            lo = i + 1;
+        }
+    }
+
+    return lo;
+}
+
+void* list_sort_task_merge(void* arg) {
+    list_sort_task_t* task = arg;
+    int64_t from = list_sort_co_rank(task, task->from - task->start);
+    int64_t to = list_sort_co_rank(task, task->to - task->start);
+    int64_t lhs = task->start + from;
+    int64_t lhs_end = task->start + to;
+    int64_t rhs = task->mid + (task->from - task->start - from);
+    int64_t rhs_end = task->mid + (task->to - task->start - to);
+    int64_t out = task->from;
+
+    while (lhs < lhs_end && rhs < rhs_end) {
+        // take from the left on ties, keeping equal elements in range order.
+        if (task->cmp(task->src[rhs], task->src[lhs], task->ctx) < 0) {
+            task->dst[out++] = task->src[rhs++];
+        } else {
+            task->dst[out++] = task->src[lhs++];
+        }
+    }
+
+    memcpy(task->dst + out, task->src + lhs, sizeof(void*) * (lhs_end - lhs));
+    out += lhs_end - lhs;
+    memcpy(task->dst + out, task->src + rhs, sizeof(void*) * (rhs_end - rhs));
+
+    return NULL;
+}
+
+typedef struct list_sort_run_t {
+    void*(*fn)(void*);
+    list_sort_task_t* tasks;
+} list_sort_run_t;
+
+void list_sort_run_range(int64_t start, int64_t end, void* ctx) {
+    list_sort_run_t* run = ctx;
+
+    for (int64_t n = start; n < end; ++n) {
+        run->fn(&run->tasks[n]);
+    }
+}
+
+// list_sort_run runs fn on every task, one task per chunk of the pool.
+void list_sort_run(void*(fn)(void*), list_sort_task_t* tasks, int64_t count) {
+    list_sort_run_t run = { .fn = fn, .tasks = tasks };
+
+    thread_pool_for(thread_pool_default(), count, 1, list_sort_run_range, &run);
+}
+
+list_t* list_sort_parallel(list_t* self, list_compare_fn cmp, void* ctx, int64_t thread_count) {
+    if (thread_count <= 0) {
+        thread_count = thread_pool_size(thread_pool_default());
+    }
+
+    int64_t runs = crumb_min(thread_count, self->size / LIST_SORT_PARALLEL_MIN_SIZE);
+    if (runs <= 1) {
+        return list_sort(self, cmp, ctx);
+    }
+
+    list_sort_task_t* tasks = malloc(sizeof(list_sort_task_t) * runs);
+    int64_t* bounds = malloc(sizeof(int64_t) * (runs + 1));
+    void** src = self->buf;
+    void** dst = malloc(sizeof(void*) * self->size);
+
+    for (int64_t n = 0; n <= runs; ++n) {
+        bounds[n] = self->size * n / runs;
+    }
+
+    for (int64_t n = 0; n < runs; ++n) {
+        tasks[n] = (list_sort_task_t) { .src = src, .start = bounds[n], .end = bounds[n + 1], .cmp = cmp, .ctx = ctx };
+    }
+    list_sort_run(list_sort_task_sort, tasks, runs);
+
+    // merge neighbouring runs pairwise, halving the number of runs each level.
+    // each merge is cut into pieces at co-ranks of its output, so the last
+    // levels keep as many threads busy as the first.
+    for (int64_t threads = runs; runs > 1;) {
+        int64_t merges = runs / 2;
+        int64_t pieces = threads / merges;
+
+        for (int64_t n = 0; n < merges; ++n) {
+            int64_t start = bounds[2 * n];
+            int64_t end = bounds[2 * n + 2];
+
+            for (int64_t p = 0; p < pieces; ++p) {
+                tasks[n * pieces + p] = (list_sort_task_t) {
+                    .src = src,
+                    .dst = dst,
+                    .start = start,
+                    .mid = bounds[2 * n + 1],
+                    .end = end,
+                    .from = start + (end - start) * p / pieces,
+                    .to = start + (end - start) * (p + 1) / pieces,
+                    .cmp = cmp,
+                    .ctx = ctx,
+                };
+            }
+        }
+        list_sort_run(list_sort_task_merge, tasks, merges * pieces);
+
+        // an odd run out is carried over to the next level unmerged.
+        if (runs % 2 == 1) {
+            memcpy(dst + bounds[runs - 1], src + bounds[runs - 1], sizeof(void*) * (bounds[runs] - bounds[runs - 1]));
+        }
+
+        for (int64_t n = 0; n <= merges; ++n) {
+            bounds[n] = bounds[crumb_min(2 * n, runs)];
+        }
+        bounds[(runs + 1) / 2] = self->size;
+        runs = (runs + 1) / 2;
+
+        void** buf = src;
+        src = dst;
+        dst = buf;
+    }
+
+    if (src != self->buf) {
+        memcpy(self->buf, src, sizeof(void*) * self->size);
+        dst = src;
+    }
+
+    free(dst);
+    free(bounds);
+    free(tasks);
+
+    return self;
+}
+
+typedef struct list_radix_task_t {
+    /*! the start of the bucket. */
+    int64_t start;
+    /*! the end of the bucket. */
+    int64_t end;
+    /*! the number of leading bytes shared by every string in the bucket. */
+    int64_t depth;
+} list_radix_task_t;
+
+CRUMB_DECLARE_LIST(list_radix_stack, list_radix_task_t, CRUMB_LIST_EQUAL_BYTES)
+
+// list_radix_digit returns the byte of s at depth plus one, or 0 past its
+// end, so shorter strings sort first.
+static inline int list_radix_digit(string_t const* s, int64_t depth) {
+    return depth < s->length ? (uint8_t) s->buf[depth] + 1 : 0;
+}
+
+static inline int list_radix_compare(string_t const* lhs, string_t const* rhs, int64_t depth) {
+    int64_t length = crumb_min(lhs->length, rhs->length) - depth;
+    int cmp = length > 0 ? memcmp(lhs->buf + depth, rhs->buf + depth, length) : 0;
+
+    if (cmp != 0) {
+        return cmp;
+    }
+
+    return (lhs->length > rhs->length) - (lhs->length < rhs->length);
+}
+
+void list_radix_insertion_sort(void** buf, int64_t size, int64_t depth) {
+    for (int64_t n = 1; n < size; ++n) {
+        void* elem = buf[n];
+        int64_t m = n;
+
+        for (; m > 0 && list_radix_compare(elem, buf[m - 1], depth) < 0; --m) {
+            buf[m] = buf[m - 1];
+        }
+        buf[m] = elem;
+    }
+}
+
+list_t* list_sort_strings(list_t* self) {
+    void** buf = self->buf;
+    void** scratch = malloc(sizeof(void*) * crumb_max(self->size, 1));
+    uint16_t* digits = malloc(sizeof(uint16_t) * crumb_max(self->size, 1));
+    list_radix_stack_t* stack = list_radix_stack_new(64);
+
+    list_radix_stack_append(stack, (list_radix_task_t) { .start = 0, .end = self->size, .depth = 0 });
+
+    list_radix_task_t task;
+    while (list_radix_stack_pop(stack, list_radix_stack_size(stack) - 1, &task)) {
+        int64_t size = task.end - task.start;
+
+        if (size < LIST_RADIX_INSERTION_THRESHOLD) {
+            list_radix_insertion_sort(buf + task.start, size, task.depth);
+            continue;
+        }
+
+        int64_t counts[257] = { 0 };
+        for (int64_t n = 0; n < size; ++n) {
+            digits[n] = list_radix_digit(buf[task.start + n], task.depth);
+            ++counts[digits[n]];
+        }
+
+        // a bucket sharing this byte too only needs the next byte looked at.
+        if (counts[digits[0]] == size) {
+            if (digits[0] != 0) {
+                list_radix_stack_append(stack, (list_radix_task_t) { .start = task.start, .end = task.end, .depth = task.depth + 1 });
+            }
+            continue;
+        }
+
+        int64_t offsets[257];
+        for (int64_t d = 0, offset = 0; d < 257; ++d) {
+            offsets[d] = offset;
+            offset += counts[d];
+        }
+
+        for (int64_t n = 0; n < size; ++n) {
+            scratch[offsets[digits[n]]++] = buf[task.start + n];
+        }
+        memcpy(buf + task.start, scratch, sizeof(void*) * size);
+
+        // strings ending here are all equal, so only bucket 1 and up recurse.
+        for (int64_t d = 1, start = task.start + counts[0]; d < 257; start += counts[d++]) {
+            if (counts[d] > 1) {
+                list_radix_stack_append(stack, (list_radix_task_t) { .start = start, .end = start + counts[d], .depth = task.depth + 1 });
+            }
+        }
+    }
+
+    list_radix_stack_free(stack);
+    free(digits);
+    free(scratch);
+
+    return self;
+}
+
+int64_t list_lower_bound(list_t* self, void* value, list_compare_fn cmp, void* ctx) {
+    int64_t lo = 0;
+    int64_t hi = self->size;
+
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+
+        if (cmp(self->buf[mid], value, ctx) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+int64_t list_bsearch(list_t* self, void* value, list_compare_fn cmp, void* ctx) {
+    int64_t index = list_lower_bound(self, value, cmp, ctx);
+
+    return index < self->size && cmp(self->buf[index], value, ctx) == 0 ? index : -1;
+}
@@ -0,0 +1,179 @@
+#include "lru_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+#define LRU_CACHE_MAP_CAPACITY 64
+
+void lru_cache_unlink(lru_cache_t* self, lru_entry_t* entry) {
+    if (entry->prev != NULL) {
+        entry->prev->next = entry->next;
+    } else {
+        self->head = entry->next;
+    }
+
+    if (entry->next != NULL) {
+        entry->next->prev = entry->prev;
+    } else {
+        self->tail = entry->prev;
+    }
+}
+
+void lru_cache_push_front(lru_cache_t* self, lru_entry_t* entry) {
+    entry->prev = NULL;
+    entry->next = self->head;
+
+    if (self->head != NULL) {
+        self->head->prev = entry;
+    } else {
+        self->tail = entry;
+    }
+    self->head = entry;
+}
+
+// lru_cache_evict removes the entry chosen by the policy and passes it to
+// the eviction function.
+void lru_cache_evict(lru_cache_t* self) {
+    lru_entry_t* entry = self->tail;
+
+    // the CLOCK hand sweeps from the back, moving referenced entries to the
+    // front once; it stops because every entry it passes is unmarked.
+    while (self->policy == LRU_POLICY_CLOCK && entry->referenced) {
+        entry->referenced = false;
+        lru_cache_unlink(self, entry);
+        lru_cache_push_front(self, entry);
+        entry = self->tail;
+    }
+
+    lru_cache_unlink(self, entry);
+    map_delete(self->map, &entry->key);
+    self->stats.cost -= entry->cost;
+    --self->stats.size;
+    ++self->stats.evictions;
+
+    if (self->on_evict != NULL) {
+        self->on_evict(&entry->key, entry->value, self->ctx);
+    }
+
+    free(entry);
+}
+
+lru_cache_t* lru_cache_new(int64_t capacity, lru_policy_t policy, lru_evict_fn* on_evict, void* ctx) {
+    lru_cache_t* self = malloc(sizeof(lru_cache_t));
+
+    self->map = map_new_flat(LRU_CACHE_MAP_CAPACITY);
+    self->head = NULL;
+    self->tail = NULL;
+    self->policy = policy;
+    self->capacity = capacity;
+    self->stats = (lru_cache_stats_t) { 0 };
+    self->on_evict = on_evict;
+    self->ctx = ctx;
+
+    return self;
+}
+
+void lru_cache_free(lru_cache_t* self) {
+    lru_entry_t* entry = self->head;
+
+    while (entry != NULL) {
+        lru_entry_t* next = entry->next;
+
+        free(entry);
+        entry = next;
+    }
+
+    map_free(self->map);
+    free(self);
+}
+
+void* lru_cache_get(lru_cache_t* self, string_t* key) {
+    lru_entry_t* entry = map_get(self->map, key);
+
+    if (entry == NULL) {
+        ++self->stats.misses;
+
+        return NULL;
+    }
+
+    ++self->stats.hits;
+
+    if (self->policy == LRU_POLICY_CLOCK) {
+        // skip the store when already marked, keeping hot entries read-only.
+        if (!entry->referenced) {
+            entry->referenced = true;
+        }
+    } else if (entry != self->head) {
+        lru_cache_unlink(self, entry);
+        lru_cache_push_front(self, entry);
+    }
+
+    return entry->value;
+}
+
+lru_cache_t* lru_cache_put(lru_cache_t* self, string_t* key, void* value, int64_t cost) {
+    lru_entry_t* entry = map_get(self->map, key);
+
+    if (entry != NULL) {
+        void* old = entry->value;
+
+        entry->value = value;
+        self->stats.cost += cost - entry->cost;
+        entry->cost = cost;
+        lru_cache_unlink(self, entry);
+        lru_cache_push_front(self, entry);
+
+        // putting the same value again keeps it cached, so it is not evicted.
+        if (self->on_evict != NULL && old != value) {
+            self->on_evict(&entry->key, old, self->ctx);
+        }
+    } else {
+        entry = malloc(sizeof(lru_entry_t) + key->length);
+
+        memcpy(entry->data, key->buf, key->length);
+        entry->key = (string_t) { .buf = entry->data, .length = key->length, .hash = string_hash(key) };
+        entry->value = value;
+        entry->cost = cost;
+        entry->referenced = false;
+        lru_cache_push_front(self, entry);
+
+        // the map borrows the entry key, which lives until the entry is freed.
+        map_set_borrowed(self->map, &entry->key, entry);
+        self->stats.cost += cost;
+        ++self->stats.size;
+    }
+
+    while (self->stats.cost > self->capacity && self->tail != NULL) {
+        lru_cache_evict(self);
+    }
+
+    return self;
+}
+
+void* lru_cache_delete(lru_cache_t* self, string_t* key) {
+    lru_entry_t* entry = map_delete(self->map, key);
+
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    void* value = entry->value;
+
+    lru_cache_unlink(self, entry);
+    self->stats.cost -= entry->cost;
+    --self->stats.size;
+    free(entry);
+
+    return value;
+}
+
+int64_t lru_cache_size(lru_cache_t* self) {
+    return self->stats.size;
+}
+
+lru_cache_stats_t lru_cache_stats(lru_cache_t* self) {
+    return self->stats;
+}
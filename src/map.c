@@ -1,177 +1,1074 @@
 #include "map.h"
 
 #include <stdlib.h>
+#include <string.h>
 
-#include "xxhash.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
+#include "arena.h"
 #include "cstrings.h"
-#include "tuple.h"
+#include "math.h"
+#include "thread_pool.h"
 
-#define CRUMB_MAP_SEED 4374805547167856529
+// the chained engine starts growing once it averages this many pairs per
+// bucket, and migrates this many old buckets per insert or delete while growing.
+#define MAP_CHAINED_MAX_LOAD 1
+#define MAP_CHAINED_MIGRATE_STEP 4
 
-void list_foreach_tuple_free_fn(void* elem) {
-    tuple_t* self = (tuple_t*) elem;
+// map_foreach_parallel deals this many chunks per thread by default.
+#define MAP_PARALLEL_CHUNKS_PER_THREAD 8
 
-    string_free(self->first);
-    tuple_free(self);
+// map_get_many resolves keys in batches of this size, so that the cache
+// misses of every key in a batch are in flight at the same time.
+#define MAP_GET_MANY_BATCH 16
+
+#define MAP_ARENA_CHUNK_SIZE 65536
+
+#define MAP_FLAT_GROUP_WIDTH 16
+#define MAP_FLAT_MIN_CAPACITY MAP_FLAT_GROUP_WIDTH
+
+// control bytes: a full slot stores the low 7 bits of its hash, while empty
+// and deleted slots have the high bit set.
+#define MAP_FLAT_EMPTY ((uint8_t) 0x80)
+#define MAP_FLAT_DELETED ((uint8_t) 0xFE)
+
+#define MAP_FLAT_H1(hash) ((hash) >> 7)
+#define MAP_FLAT_H2(hash) ((uint8_t) ((hash) & 0x7F))
+
+void list_foreach_bucket_free_fn(void* elem) {
+    // entries live in the map's arena, so only the bucket itself is freed.
+    if (elem != NULL) {
+        list_free((list_t*) elem);
+    }
 }
 
-void list_foreach_tuple_list_free_fn(void* elem) {
-    list_t* self = (list_t*) elem;
+int64_t map_entry_size(int64_t length) {
+    return sizeof(map_entry_t) + length;
+}
+
+map_entry_t* map_entry_new(map_t* self, string_t* key, uint64_t hash, void* value, map_key_owner_t owner) {
+    int64_t length = owner == MAP_KEY_INLINE ? string_length(key) : 0;
+    map_entry_t* entry = arena_alloc(self->arena, map_entry_size(length));
+    entry->key.buf = owner == MAP_KEY_INLINE ? entry->data : string_data(key);
+    entry->key.length = string_length(key);
+    entry->key.hash = hash;
+    entry->value = value;
+    entry->owner = owner;
+
+    memcpy(entry->data, string_data(key), length);
 
-    list_foreach(self, list_foreach_tuple_free_fn);
-    list_free(self);
+    return entry;
 }
 
-uint64_t map_hash_key(map_t* self, string_t* key) {
-    return XXH64(string_data(key), string_length(key), CRUMB_MAP_SEED) % list_size(self->buckets);
+void map_entry_free(map_t* self, map_entry_t* entry) {
+    arena_release(self->arena, entry, map_entry_size(entry->owner == MAP_KEY_INLINE ? entry->key.length : 0));
 }
 
-map_t* map_new(int64_t bucket_count, int64_t bucket_capacity) {
-    map_t* self = malloc(sizeof(map_t*));
-    self->buckets = list_new(bucket_count);
+void map_key_adopt(map_t* self, string_t* key, map_key_owner_t owner, bool stored) {
+    if (owner != MAP_KEY_TAKEN) {
+        return;
+    }
+
+    // a stored key's data now belongs to the map, so only its string_t is freed.
+    if (stored) {
+        free(key);
+        ++self->taken;
+    } else {
+        string_free(key);
+    }
+}
+
+void map_key_remove(map_t* self, string_t* key, uint8_t owner, string_t** stored_key) {
+    if (owner == MAP_KEY_TAKEN) {
+        --self->taken;
+    }
+
+    if (stored_key == NULL) {
+        if (owner == MAP_KEY_TAKEN) {
+            free(key->buf);
+        }
+
+        return;
+    }
+
+    if (owner == MAP_KEY_TAKEN) {
+        *stored_key = malloc(sizeof(string_t));
+        **stored_key = *key;
+    } else {
+        *stored_key = string(key->buf, key->length);
+        (*stored_key)->hash = key->hash;
+    }
+}
+
+void map_free_taken(map_t* self) {
+    if (self->taken == 0) {
+        return;
+    }
+
+    for (map_iter_t iter = map_iter(self); map_iter_next(&iter);) {
+        // a chained entry starts with its key.
+        uint8_t owner = self->engine == MAP_ENGINE_FLAT ? self->owners[iter.bucket] : ((map_entry_t*) iter.key)->owner;
+
+        if (owner == MAP_KEY_TAKEN) {
+            free(iter.key->buf);
+        }
+    }
+
+    self->taken = 0;
+}
+
+#if defined(__SSE2__)
+static inline uint32_t map_flat_group_match(uint8_t const* group, uint8_t h2) {
+    __m128i ctrl = _mm_loadu_si128((__m128i const*) group);
+
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char) h2)));
+}
+
+static inline uint32_t map_flat_group_match_free(uint8_t const* group) {
+    __m128i ctrl = _mm_loadu_si128((__m128i const*) group);
+
+    return (uint32_t) _mm_movemask_epi8(ctrl);
+}
+#else
+static inline uint32_t map_flat_group_match(uint8_t const* group, uint8_t h2) {
+    uint32_t mask = 0;
+
+    for (int n = 0; n < MAP_FLAT_GROUP_WIDTH; ++n) {
+        mask |= (uint32_t) (group[n] == h2) << n;
+    }
+
+    return mask;
+}
+
+static inline uint32_t map_flat_group_match_free(uint8_t const* group) {
+    uint32_t mask = 0;
+
+    for (int n = 0; n < MAP_FLAT_GROUP_WIDTH; ++n) {
+        mask |= (uint32_t) (group[n] >> 7) << n;
+    }
+
+    return mask;
+}
+#endif
+
+static inline uint32_t map_flat_group_match_empty(uint8_t const* group) {
+    return map_flat_group_match(group, MAP_FLAT_EMPTY);
+}
+
+int64_t map_flat_find(map_t const* self, uint64_t hash, char const* data, int64_t length) {
+    int64_t group_mask = self->capacity / MAP_FLAT_GROUP_WIDTH - 1;
+    int64_t group = MAP_FLAT_H1(hash) & group_mask;
+
+    // triangular probing visits every group once the table size is a power of two.
+    for (int64_t step = 1; ; ++step) {
+        uint8_t const* ctrl = self->ctrl + group * MAP_FLAT_GROUP_WIDTH;
+
+        for (uint32_t match = map_flat_group_match(ctrl, MAP_FLAT_H2(hash)); match != 0; match &= match - 1) {
+            int64_t index = group * MAP_FLAT_GROUP_WIDTH + __builtin_ctz(match);
+            map_slot_t const* slot = &self->slots[index];
+
+            if (slot->key.hash == hash && slot->key.length == length && memcmp(slot->key.buf, data, length) == 0) {
+                return index;
+            }
+        }
+
+        if (map_flat_group_match_empty(ctrl) != 0) {
+            return -1;
+        }
+
+        group = (group + step) & group_mask;
+    }
+}
+
+int64_t map_flat_find_free(map_t const* self, uint64_t hash) {
+    int64_t group_mask = self->capacity / MAP_FLAT_GROUP_WIDTH - 1;
+    int64_t group = MAP_FLAT_H1(hash) & group_mask;
+
+    for (int64_t step = 1; ; ++step) {
+        uint32_t match = map_flat_group_match_free(self->ctrl + group * MAP_FLAT_GROUP_WIDTH);
+
+        if (match != 0) {
+            return group * MAP_FLAT_GROUP_WIDTH + __builtin_ctz(match);
+        }
+
+        group = (group + step) & group_mask;
+    }
+}
+
+void map_flat_alloc(map_t* self, int64_t capacity) {
+    self->capacity = capacity;
+    self->size = 0;
+    self->growth_left = capacity - capacity / 8;
+    self->ctrl = malloc(sizeof(uint8_t) * capacity);
+    self->slots = malloc(sizeof(map_slot_t) * capacity);
+
+    memset(self->ctrl, MAP_FLAT_EMPTY, capacity);
+}
+
+void map_flat_rehash(map_t* self) {
+    uint8_t* old_ctrl = self->ctrl;
+    map_slot_t* old_slots = self->slots;
+    int64_t old_capacity = self->capacity;
+    uint8_t* old_owners = self->owners;
+    int64_t size = self->size;
+
+    // rehash in place when deleted slots, rather than live pairs, exhausted the growth budget.
+    int64_t capacity = old_capacity;
+    if ((size + 1) * 16 > old_capacity * 7) {
+        capacity *= 2;
+    }
+
+    map_flat_alloc(self, capacity);
+    self->owners = old_owners != NULL ? calloc(capacity, sizeof(uint8_t)) : NULL;
+
+    for (int64_t n = 0; n < old_capacity; ++n) {
+        if (old_ctrl[n] & MAP_FLAT_EMPTY) {
+            continue;
+        }
+
+        int64_t index = map_flat_find_free(self, old_slots[n].key.hash);
+        self->ctrl[index] = old_ctrl[n];
+        self->slots[index] = old_slots[n];
+
+        if (old_owners != NULL) {
+            self->owners[index] = old_owners[n];
+        }
+    }
+
+    self->size = size;
+    self->growth_left -= size;
+
+    free(old_ctrl);
+    free(old_slots);
+    free(old_owners);
+    ++self->resizes;
+}
+
+void** map_flat_upsert(map_t* self, string_t* key, uint64_t hash, map_key_owner_t owner, bool* inserted) {
+    int64_t index = map_flat_find(self, hash, string_data(key), string_length(key));
+
+    *inserted = index < 0;
+    if (index >= 0) {
+        map_key_adopt(self, key, owner, false);
+
+        return &self->slots[index].value;
+    }
+
+    index = map_flat_find_free(self, hash);
+    if (self->ctrl[index] == MAP_FLAT_EMPTY && self->growth_left == 0) {
+        map_flat_rehash(self);
+        index = map_flat_find_free(self, hash);
+    }
+
+    if (self->ctrl[index] == MAP_FLAT_EMPTY) {
+        --self->growth_left;
+    }
+
+    map_slot_t* slot = &self->slots[index];
+    slot->key.hash = hash;
+    slot->key.length = string_length(key);
+    slot->value = NULL;
+
+    if (owner == MAP_KEY_INLINE) {
+        slot->key.buf = arena_alloc(self->arena, slot->key.length);
+        memcpy(slot->key.buf, string_data(key), slot->key.length);
+    } else {
+        slot->key.buf = string_data(key);
+    }
+
+    // owners is only allocated once a key is not inline, so plain maps never pay for it.
+    if (self->owners == NULL && owner != MAP_KEY_INLINE) {
+        self->owners = calloc(self->capacity, sizeof(uint8_t));
+    }
+    if (self->owners != NULL) {
+        self->owners[index] = owner;
+    }
+
+    self->ctrl[index] = MAP_FLAT_H2(hash);
+    ++self->size;
+
+    map_key_adopt(self, key, owner, true);
+
+    return &slot->value;
+}
+
+void* map_flat_delete(map_t* self, string_t* key, string_t** stored_key) {
+    uint64_t hash = string_hash(key);
+    int64_t index = map_flat_find(self, hash, string_data(key), string_length(key));
+
+    if (index < 0) {
+        return NULL;
+    }
+
+    map_slot_t* slot = &self->slots[index];
+    uint8_t owner = self->owners != NULL ? self->owners[index] : MAP_KEY_INLINE;
+    void* elem = slot->value;
+
+    map_key_remove(self, &slot->key, owner, stored_key);
+    if (owner == MAP_KEY_INLINE) {
+        arena_release(self->arena, slot->key.buf, slot->key.length);
+    }
+    if (self->owners != NULL) {
+        self->owners[index] = MAP_KEY_INLINE;
+    }
+
+    // a probe never continues past a group with an empty slot, so the slot
+    // can be emptied instead of marked deleted if its group has one.
+    uint8_t* group = self->ctrl + index - (index % MAP_FLAT_GROUP_WIDTH);
+    if (map_flat_group_match_empty(group) != 0) {
+        self->ctrl[index] = MAP_FLAT_EMPTY;
+        ++self->growth_left;
+    } else {
+        self->ctrl[index] = MAP_FLAT_DELETED;
+    }
+    --self->size;
+
+    return elem;
+}
+
+void* map_flat_get(map_t* self, string_t* key, uint64_t hash) {
+    int64_t index = map_flat_find(self, hash, string_data(key), string_length(key));
 
+    return index >= 0 ? self->slots[index].value : NULL;
+}
+
+int64_t map_flat_home(map_t const* self, uint64_t hash) {
+    return (MAP_FLAT_H1(hash) & (self->capacity / MAP_FLAT_GROUP_WIDTH - 1)) * MAP_FLAT_GROUP_WIDTH;
+}
+
+void map_flat_prefetch_group(map_t const* self, uint64_t hash) {
+    int64_t home = map_flat_home(self, hash);
+
+    __builtin_prefetch(self->ctrl + home);
+    __builtin_prefetch(self->slots + home);
+}
+
+void map_flat_prefetch_key(map_t const* self, uint64_t hash) {
+    int64_t home = map_flat_home(self, hash);
+    uint32_t match = map_flat_group_match(self->ctrl + home, MAP_FLAT_H2(hash));
+
+    if (match != 0) {
+        __builtin_prefetch(self->slots[home + __builtin_ctz(match)].key.buf);
+    }
+}
+
+list_t* map_chained_buckets_new(int64_t bucket_count) {
+    list_t* buckets = list_new(bucket_count);
+
+    // buckets are allocated on first insert, so an over-sized map only pays
+    // for one pointer per empty bucket.
     for (int64_t n = 0; n < bucket_count; ++n) {
-        self->buckets = list_append(self->buckets, list_new(bucket_capacity));
+        buckets = list_append(buckets, NULL);
     }
 
-    return self;
+    return buckets;
 }
 
-map_t* map_copy(map_t* self, int64_t bucket_count, int64_t bucket_capacity) {
-    map_t* other = map_new(bucket_count, bucket_capacity);
+void map_chained_buckets_free(list_t* buckets) {
+    if (buckets == NULL) {
+        return;
+    }
+
+    list_foreach(buckets, list_foreach_bucket_free_fn);
+    list_free(buckets);
+}
+
+list_t* map_chained_bucket(map_t* self, uint64_t hash) {
+    int64_t index = hash % list_size(self->buckets);
+    list_t* bucket = list_get(self->buckets, index);
+
+    if (bucket == NULL) {
+        bucket = list_new(self->bucket_capacity);
+        list_set(self->buckets, index, bucket);
+    }
+
+    return bucket;
+}
+
+// map_chained_find_bucket never migrates, so lookups leave the map untouched.
+list_t* map_chained_find_bucket(map_t* self, uint64_t hash) {
+    // a key stays in its old bucket until that whole bucket is migrated.
+    if (self->old_buckets != NULL) {
+        list_t* bucket = list_get(self->old_buckets, hash % list_size(self->old_buckets));
+
+        if (bucket != NULL) {
+            return bucket;
+        }
+    }
+
+    return list_get(self->buckets, hash % list_size(self->buckets));
+}
+
+int64_t map_chained_find(list_t* bucket, uint64_t hash, string_t* key) {
+    if (bucket == NULL) {
+        return -1;
+    }
+
+    for (int64_t n = 0; n < list_size(bucket); ++n) {
+        map_entry_t* entry = list_get(bucket, n);
+
+        // entries always store their hash, so most mismatches never touch the key data.
+        if (entry->key.hash == hash && string_equal(key, &entry->key)) {
+            return n;
+        }
+    }
+
+    return -1;
+}
+
+void map_chained_migrate_bucket(map_t* self, int64_t index) {
+    list_t* bucket = list_get(self->old_buckets, index);
+
+    if (bucket == NULL) {
+        return;
+    }
+
+    for (int64_t n = 0; n < list_size(bucket); ++n) {
+        map_entry_t* entry = list_get(bucket, n);
+
+        list_append(map_chained_bucket(self, entry->key.hash), entry);
+    }
+
+    list_free(bucket);
+    list_set(self->old_buckets, index, NULL);
+}
+
+void map_chained_migrate(map_t* self, int64_t count) {
+    while (self->old_buckets != NULL && count-- > 0) {
+        map_chained_migrate_bucket(self, self->migrate_index);
+
+        if (++self->migrate_index == list_size(self->old_buckets)) {
+            list_free(self->old_buckets);
+            self->old_buckets = NULL;
+            self->migrate_index = 0;
+        }
+    }
+}
+
+void map_chained_migrate_key(map_t* self, uint64_t hash) {
+    if (self->old_buckets == NULL) {
+        return;
+    }
+
+    // move the key's own bucket first so it is only ever found in the new buckets.
+    map_chained_migrate_bucket(self, hash % list_size(self->old_buckets));
+    map_chained_migrate(self, MAP_CHAINED_MIGRATE_STEP);
+}
+
+void map_chained_grow(map_t* self) {
+    map_chained_migrate(self, INT64_MAX);
+
+    self->old_buckets = self->buckets;
+    self->buckets = map_chained_buckets_new(list_size(self->old_buckets) * 2);
+    self->migrate_index = 0;
+    ++self->resizes;
+}
+
+void** map_chained_upsert(map_t* self, string_t* key, uint64_t hash, map_key_owner_t owner, bool* inserted) {
+    map_chained_migrate_key(self, hash);
+
+    list_t* bucket = map_chained_bucket(self, hash);
+    int64_t index = map_chained_find(bucket, hash, key);
+
+    *inserted = index < 0;
+    if (index >= 0) {
+        map_key_adopt(self, key, owner, false);
+
+        return &((map_entry_t*) list_get(bucket, index))->value;
+    }
+
+    if (self->size >= list_size(self->buckets) * MAP_CHAINED_MAX_LOAD) {
+        map_chained_grow(self);
+        map_chained_migrate_key(self, hash);
+        bucket = map_chained_bucket(self, hash);
+    }
+
+    // entries never move once allocated, so the value pointer outlives later growth.
+    map_entry_t* entry = map_entry_new(self, key, hash, NULL, owner);
+    list_append(bucket, entry);
+    ++self->size;
+
+    map_key_adopt(self, key, owner, true);
+
+    return &entry->value;
+}
+
+void* map_chained_delete(map_t* self, string_t* key, string_t** stored_key) {
+    uint64_t hash = string_hash(key);
+
+    map_chained_migrate_key(self, hash);
+
+    list_t* bucket = list_get(self->buckets, hash % list_size(self->buckets));
+    int64_t index = map_chained_find(bucket, hash, key);
+
+    if (index < 0) {
+        return NULL;
+    }
+
+    map_entry_t* entry = list_pop(bucket, index);
+    void* elem = entry->value;
 
-    for (int64_t b = 0; b < list_size(self->buckets); ++b) {
-        list_t* bucket = list_get(self->buckets, b);
+    map_key_remove(self, &entry->key, entry->owner, stored_key);
+    map_entry_free(self, entry);
+    --self->size;
 
+    return elem;
+}
+
+void* map_chained_get(map_t* self, string_t* key, uint64_t hash) {
+    list_t* bucket = map_chained_find_bucket(self, hash);
+    int64_t index = map_chained_find(bucket, hash, key);
+
+    if (index < 0) {
+        return NULL;
+    }
+
+    return ((map_entry_t*) list_get(bucket, index))->value;
+}
+
+void map_chained_prefetch_bucket(map_t* self, uint64_t hash) {
+    list_t* buckets = self->buckets;
+
+    if (self->old_buckets != NULL && list_get(self->old_buckets, hash % list_size(self->old_buckets)) != NULL) {
+        buckets = self->old_buckets;
+    }
+
+    __builtin_prefetch(buckets->buf + hash % list_size(buckets));
+}
+
+void map_chained_prefetch_entries(map_t* self, uint64_t hash, int stage) {
+    list_t* bucket = map_chained_find_bucket(self, hash);
+
+    if (bucket == NULL) {
+        return;
+    }
+
+    if (stage == 0) {
+        __builtin_prefetch(bucket);
+    } else if (stage == 1) {
+        __builtin_prefetch(bucket->buf);
+    } else if (list_size(bucket) > 0) {
+        __builtin_prefetch(bucket->buf[0]);
+    }
+}
+
+map_entry_t* map_entry_clone(map_t* self, map_entry_t* entry) {
+    map_entry_t* clone = arena_alloc(self->arena, map_entry_size(entry->key.length));
+
+    // a clone keeps its own copy of taken and borrowed keys.
+    memcpy(clone, entry, sizeof(map_entry_t));
+    memcpy(clone->data, entry->key.buf, entry->key.length);
+    clone->key.buf = clone->data;
+    clone->owner = MAP_KEY_INLINE;
+
+    return clone;
+}
+
+map_t* map_chained_clone(map_t* self, int64_t bucket_capacity) {
+    map_t* other = map_new(list_size(self->buckets), bucket_capacity);
+
+    // clone each bucket as-is, so no key is rehashed or compared.
+    for (int64_t n = 0; n < list_size(self->buckets); ++n) {
+        list_t* bucket = self->buckets->buf[n];
+
+        if (bucket == NULL || list_size(bucket) == 0) {
+            continue;
+        }
+
+        list_t* clone = list_new(crumb_max(other->bucket_capacity, list_size(bucket)));
         for (int64_t p = 0; p < list_size(bucket); ++p) {
-            tuple_t* pair = (tuple_t*) list_get(bucket, p);
+            clone->buf[p] = map_entry_clone(other, bucket->buf[p]);
+        }
+        clone->size = list_size(bucket);
+
+        other->buckets->buf[n] = clone;
+    }
+    other->size = self->size;
+
+    return other;
+}
+
+map_t* map_flat_clone(map_t* self) {
+    map_t* other = map_new_flat(0);
+
+    free(other->ctrl);
+    free(other->slots);
+    map_flat_alloc(other, self->capacity);
+
+    // slots keep their positions, so only the key data needs copying.
+    memcpy(other->ctrl, self->ctrl, self->capacity);
+    memcpy(other->slots, self->slots, sizeof(map_slot_t) * self->capacity);
+
+    for (int64_t n = 0; n < self->capacity; ++n) {
+        if ((self->ctrl[n] & MAP_FLAT_EMPTY) == 0) {
+            map_slot_t* slot = &other->slots[n];
+            char* buf = arena_alloc(other->arena, slot->key.length);
 
-            other = map_set(other, (string_t*) pair->first, pair->second);
+            memcpy(buf, slot->key.buf, slot->key.length);
+            slot->key.buf = buf;
         }
     }
+    other->size = self->size;
+    other->growth_left = self->growth_left;
+
+    return other;
+}
+
+map_t* map_new(int64_t bucket_count, int64_t bucket_capacity) {
+    map_t* self = malloc(sizeof(map_t));
+    self->engine = MAP_ENGINE_CHAINED;
+    self->buckets = map_chained_buckets_new(crumb_max(bucket_count, 1));
+    self->old_buckets = NULL;
+    self->migrate_index = 0;
+    self->bucket_capacity = crumb_max(bucket_capacity, 1);
+    self->arena = arena_new(MAP_ARENA_CHUNK_SIZE);
+    self->ctrl = NULL;
+    self->slots = NULL;
+    self->capacity = 0;
+    self->size = 0;
+    self->growth_left = 0;
+    self->owners = NULL;
+    self->taken = 0;
+    self->resizes = 0;
+
+    return self;
+}
+
+map_t* map_new_flat(int64_t capacity) {
+    map_t* self = malloc(sizeof(map_t));
+    self->engine = MAP_ENGINE_FLAT;
+    self->buckets = NULL;
+    self->old_buckets = NULL;
+    self->migrate_index = 0;
+    self->bucket_capacity = 0;
+    self->arena = arena_new(MAP_ARENA_CHUNK_SIZE);
+    self->owners = NULL;
+    self->taken = 0;
+    self->resizes = 0;
+
+    // keep the table at most 7/8 full, with a power of two number of groups.
+    int64_t slots = MAP_FLAT_MIN_CAPACITY;
+    while (slots - slots / 8 < capacity) {
+        slots *= 2;
+    }
+    map_flat_alloc(self, slots);
+
+    return self;
+}
+
+map_t* map_copy(map_t* self, int64_t bucket_count, int64_t bucket_capacity) {
+    if (self->engine == MAP_ENGINE_FLAT) {
+        return map_flat_clone(self);
+    }
+
+    if (bucket_count == list_size(self->buckets)) {
+        map_chained_migrate(self, INT64_MAX);
+
+        return map_chained_clone(self, bucket_capacity);
+    }
+
+    map_t* other = map_new(bucket_count, bucket_capacity);
+
+    for (map_iter_t iter = map_iter(self); map_iter_next(&iter);) {
+        other = map_set_hashed(other, iter.key, iter.key->hash, iter.value);
+    }
 
     return other;
 }
 
 void map_free(map_t* self) {
-    list_foreach(self->buckets, list_foreach_tuple_list_free_fn);
-    list_free(self->buckets);
+    map_free_taken(self);
+
+    if (self->engine == MAP_ENGINE_FLAT) {
+        free(self->ctrl);
+        free(self->slots);
+        free(self->owners);
+    }
+
+    map_chained_buckets_free(self->old_buckets);
+    map_chained_buckets_free(self->buckets);
+    arena_free(self->arena);
     free(self);
 }
 
 map_t* map_clear(map_t* self) {
-    int64_t bucket_count = list_size(self->buckets);
-    int64_t bucket_capacity = 0;
+    map_free_taken(self);
+    arena_clear(self->arena);
+
+    if (self->engine == MAP_ENGINE_FLAT) {
+        free(self->owners);
+        self->owners = NULL;
+        memset(self->ctrl, MAP_FLAT_EMPTY, self->capacity);
+        self->size = 0;
+        self->growth_left = self->capacity - self->capacity / 8;
 
-    if (bucket_count > 0) {
-        bucket_capacity = list_capacity((list_t*) list_get(self->buckets, 0));
+        return self;
     }
 
-    for (int64_t n = 0; n < bucket_count; ++n) {
-        list_t* bucket = list_get(self->buckets, n);
+    int64_t bucket_count = list_size(self->buckets);
 
-        list_foreach(bucket, list_foreach_tuple_free_fn);
-        list_free(bucket);
-    }
-    list_free(self->buckets);
+    map_chained_buckets_free(self->old_buckets);
+    map_chained_buckets_free(self->buckets);
 
-    self->buckets = list_new(bucket_count);
-    for (int64_t n = 0; n < bucket_count; ++n) {
-        self->buckets = list_append(self->buckets, list_new(bucket_capacity));
-    }
+    self->buckets = map_chained_buckets_new(bucket_count);
+    self->old_buckets = NULL;
+    self->migrate_index = 0;
+    self->size = 0;
 
     return self;
 }
 
 map_t* map_set(map_t* self, string_t* key, void* value) {
-    list_t* bucket = list_get(self->buckets, map_hash_key(self, key));
+    return map_set_hashed(self, key, string_hash(key), value);
+}
 
-    for (int64_t index = 0; index < list_size(bucket); ++index) {
-        tuple_t* pair = list_get(bucket, index);
+void** map_upsert(map_t* self, string_t* key, uint64_t hash, map_key_owner_t owner, bool* inserted) {
+    if (self->engine == MAP_ENGINE_FLAT) {
+        return map_flat_upsert(self, key, hash, owner, inserted);
+    }
 
-        if (string_equal(key, (string_t*) pair->first)) {
-            // cleanup the old key-value pair
-            string_free((string_t*) pair->first);
-            tuple_free(pair);
+    return map_chained_upsert(self, key, hash, owner, inserted);
+}
 
-            list_set(bucket, index, tuple_new(string_copy(key), value));
+map_t* map_set_hashed(map_t* self, string_t* key, uint64_t hash, void* value) {
+    bool inserted;
 
-            return self;
-        }
-    }
+    *map_upsert(self, key, hash, MAP_KEY_INLINE, &inserted) = value;
+
+    return self;
+}
+
+map_t* map_set_take(map_t* self, string_t* key, void* value) {
+    bool inserted;
 
-    list_append(bucket, tuple_new(string_copy(key), value));
+    *map_upsert(self, key, string_hash(key), MAP_KEY_TAKEN, &inserted) = value;
 
     return self;
 }
 
+map_t* map_set_borrowed(map_t* self, string_t* key, void* value) {
+    bool inserted;
+
+    *map_upsert(self, key, string_hash(key), MAP_KEY_BORROWED, &inserted) = value;
+
+    return self;
+}
+
+void** map_get_or_insert(map_t* self, string_t* key, bool* inserted) {
+    return map_upsert(self, key, string_hash(key), MAP_KEY_INLINE, inserted);
+}
+
+void* map_update(map_t* self, string_t* key, map_update_fn fn, void* ctx) {
+    bool inserted;
+    void** value = map_upsert(self, key, string_hash(key), MAP_KEY_INLINE, &inserted);
+
+    *value = fn(*value, ctx);
+
+    return *value;
+}
+
+bool map_includes(map_t* self, map_t* other) {
+    for (map_iter_t iter = map_iter(self); map_iter_next(&iter);) {
+        if (map_get(other, iter.key) != iter.value) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool map_equal(map_t* lhs, map_t* rhs) {
     if (lhs == rhs) {
         return true;
     }
 
-    for (int n = 0; n < list_size(lhs->buckets); ++n) {
-        list_t* bucket = list_get(lhs->buckets, n);
+    return map_includes(lhs, rhs) && map_includes(rhs, lhs);
+}
+
+void* map_delete(map_t* self, string_t* key) {
+    if (self->engine == MAP_ENGINE_FLAT) {
+        return map_flat_delete(self, key, NULL);
+    }
+
+    return map_chained_delete(self, key, NULL);
+}
+
+void* map_delete_take(map_t* self, string_t* key, string_t** stored_key) {
+    *stored_key = NULL;
+
+    if (self->engine == MAP_ENGINE_FLAT) {
+        return map_flat_delete(self, key, stored_key);
+    }
+
+    return map_chained_delete(self, key, stored_key);
+}
+
+void* map_delete_bytes(map_t* self, char const* data, int64_t length) {
+    string_t key = string_view(data, length);
+
+    return map_delete(self, &key);
+}
+
+void* map_get(map_t* self, string_t* key) {
+    return map_get_hashed(self, key, string_hash(key));
+}
+
+void* map_get_bytes(map_t* self, char const* data, int64_t length) {
+    string_t key = string_view(data, length);
+
+    return map_get_hashed(self, &key, string_hash(&key));
+}
+
+bool map_contains_bytes(map_t* self, char const* data, int64_t length) {
+    string_t key = string_view(data, length);
+    uint64_t hash = string_hash(&key);
 
-        for (int p = 0; p < list_size(bucket); ++p) {
-            tuple_t* pair = list_get(bucket, p);
-            string_t* key = pair->first;
+    if (self->engine == MAP_ENGINE_FLAT) {
+        return map_flat_find(self, hash, data, length) >= 0;
+    }
 
-            void* value = map_get(rhs, key);
-            if (value != pair->second) {
-                return false;
+    return map_chained_find(map_chained_find_bucket(self, hash), hash, &key) >= 0;
+}
+
+void* map_get_hashed(map_t* self, string_t* key, uint64_t hash) {
+    if (self->engine == MAP_ENGINE_FLAT) {
+        return map_flat_get(self, key, hash);
+    }
+
+    return map_chained_get(self, key, hash);
+}
+
+void map_get_many(map_t* self, string_t** keys, int64_t count, void** out) {
+    uint64_t hashes[MAP_GET_MANY_BATCH];
+
+    for (int64_t start = 0; start < count; start += MAP_GET_MANY_BATCH) {
+        int64_t batch = crumb_min(count - start, MAP_GET_MANY_BATCH);
+
+        // each pass issues one dependent load per key, so a batch waits on
+        // one miss per pass rather than one miss per key per pass.
+        if (self->engine == MAP_ENGINE_FLAT) {
+            for (int64_t n = 0; n < batch; ++n) {
+                hashes[n] = string_hash(keys[start + n]);
+                map_flat_prefetch_group(self, hashes[n]);
+            }
+
+            for (int64_t n = 0; n < batch; ++n) {
+                map_flat_prefetch_key(self, hashes[n]);
+            }
+        } else {
+            for (int64_t n = 0; n < batch; ++n) {
+                hashes[n] = string_hash(keys[start + n]);
+                map_chained_prefetch_bucket(self, hashes[n]);
             }
+
+            for (int stage = 0; stage < 3; ++stage) {
+                for (int64_t n = 0; n < batch; ++n) {
+                    map_chained_prefetch_entries(self, hashes[n], stage);
+                }
+            }
+        }
+
+        for (int64_t n = 0; n < batch; ++n) {
+            out[start + n] = map_get_hashed(self, keys[start + n], hashes[n]);
         }
     }
+}
 
-    for (int n = 0; n < list_size(rhs->buckets); ++n) {
-        list_t* bucket = list_get(rhs->buckets, n);
+int64_t map_size(map_t* self) {
+    return self->size;
+}
 
-        for (int p = 0; p < list_size(bucket); ++p) {
-            tuple_t* pair = list_get(bucket, p);
-            string_t* key = pair->first;
+void map_stats_add_probe(map_stats_t* stats, int64_t length) {
+    ++stats->histogram[crumb_min(length, MAP_STATS_HISTOGRAM_SIZE - 1)];
+    stats->max_probe_length = crumb_max(stats->max_probe_length, length);
+    stats->mean_probe_length += length;
+    stats->collisions += length > 0;
+}
 
-            void* value = map_get(lhs, key);
-            if (value != pair->second) {
-                return false;
+int64_t map_stats_add_buckets(map_stats_t* stats, list_t* buckets, int64_t* taken_bytes) {
+    if (buckets == NULL) {
+        return 0;
+    }
+
+    int64_t bytes = sizeof(list_t) + sizeof(void*) * list_capacity(buckets);
+
+    for (int64_t n = 0; n < list_size(buckets); ++n) {
+        list_t* bucket = list_get(buckets, n);
+
+        if (bucket == NULL) {
+            continue;
+        }
+
+        for (int64_t p = 0; p < list_size(bucket); ++p) {
+            map_entry_t* entry = list_get(bucket, p);
+
+            map_stats_add_probe(stats, p);
+            stats->key_bytes += entry->key.length;
+            *taken_bytes += entry->owner == MAP_KEY_TAKEN ? entry->key.length : 0;
+        }
+        bytes += sizeof(list_t) + sizeof(void*) * list_capacity(bucket);
+    }
+
+    stats->bucket_count += list_size(buckets);
+
+    return bytes;
+}
+
+void map_stats(map_t* self, map_stats_t* stats) {
+    *stats = (map_stats_t) {
+        .engine = self->engine,
+        .size = self->size,
+        .resizes = self->resizes,
+        .entry_bytes = self->arena->bytes,
+    };
+    int64_t taken_bytes = 0;
+
+    if (self->engine == MAP_ENGINE_FLAT) {
+        int64_t group_mask = self->capacity / MAP_FLAT_GROUP_WIDTH - 1;
+
+        for (int64_t n = 0; n < self->capacity; ++n) {
+            if (self->ctrl[n] & MAP_FLAT_EMPTY) {
+                continue;
+            }
+
+            // replay the triangular probe sequence from the home group.
+            int64_t group = map_flat_home(self, self->slots[n].key.hash) / MAP_FLAT_GROUP_WIDTH;
+            int64_t length = 0;
+
+            while (group != n / MAP_FLAT_GROUP_WIDTH) {
+                group = (group + ++length) & group_mask;
+            }
+
+            map_stats_add_probe(stats, length);
+            stats->key_bytes += self->slots[n].key.length;
+            if (self->owners != NULL && self->owners[n] == MAP_KEY_TAKEN) {
+                taken_bytes += self->slots[n].key.length;
             }
         }
+
+        stats->bucket_count = self->capacity;
+        stats->table_bytes = (sizeof(uint8_t) + sizeof(map_slot_t)) * self->capacity;
+        stats->table_bytes += self->owners != NULL ? self->capacity : 0;
+    } else {
+        stats->table_bytes = map_stats_add_buckets(stats, self->old_buckets, &taken_bytes) + map_stats_add_buckets(stats, self->buckets, &taken_bytes);
     }
 
-    return true;
+    stats->load_factor = (double) self->size / stats->bucket_count;
+    stats->mean_probe_length = self->size > 0 ? stats->mean_probe_length / self->size : 0;
+    stats->bytes = sizeof(map_t) + sizeof(arena_t) + stats->table_bytes;
+    stats->bytes += sizeof(list_t) + sizeof(void*) * list_capacity(self->arena->chunks);
+    stats->bytes += self->arena->chunk_size * list_size(self->arena->chunks);
+
+    // taken keys were allocated by the caller rather than the arena.
+    stats->bytes += taken_bytes;
 }
 
-void* map_delete(map_t* self, string_t* key) {
-    list_t* bucket = list_get(self->buckets, map_hash_key(self, key));
+map_iter_t map_iter(map_t* self) {
+    map_iter_t iter = {
+        .map = self,
+        .buckets = self->old_buckets != NULL ? self->old_buckets : self->buckets,
+        .bucket = self->engine == MAP_ENGINE_FLAT ? -1 : 0,
+        .index = -1,
+        .key = NULL,
+        .value = NULL,
+    };
+
+    return iter;
+}
+
+bool map_iter_next(map_iter_t* iter) {
+    map_t* self = iter->map;
 
-    for (int n = 0; n < list_size(bucket); ++n) {
-        tuple_t* pair = list_get(bucket, n);
+    if (self->engine == MAP_ENGINE_FLAT) {
+        while (++iter->bucket < self->capacity) {
+            if ((self->ctrl[iter->bucket] & MAP_FLAT_EMPTY) == 0) {
+                iter->key = &self->slots[iter->bucket].key;
+                iter->value = self->slots[iter->bucket].value;
 
-        if (string_equal(key, (string_t*) pair->first)) {
-            void* elem = pair->second;
-            bucket = list_remove(bucket, pair);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    while (iter->buckets != NULL) {
+        list_t* bucket = iter->buckets->buf[iter->bucket];
+
+        if (bucket != NULL && ++iter->index < bucket->size) {
+            map_entry_t* entry = bucket->buf[iter->index];
+            iter->key = &entry->key;
+            iter->value = entry->value;
 
-            string_free((string_t*) pair->first);
-            tuple_free(pair);
+            return true;
+        }
 
-            return elem;
+        // buckets still being migrated are walked before the new buckets.
+        iter->index = -1;
+        if (++iter->bucket == iter->buckets->size) {
+            iter->buckets = iter->buckets == self->old_buckets ? self->buckets : NULL;
+            iter->bucket = 0;
         }
     }
 
-    return NULL;
+    return false;
 }
 
-void* map_get(map_t* self, string_t* key) {
-    list_t* bucket = list_get(self->buckets, map_hash_key(self, key));
+void map_foreach(map_t* self, map_fn fn, void* ctx) {
+    for (map_iter_t iter = map_iter(self); map_iter_next(&iter);) {
+        fn(iter.key, iter.value, ctx);
+    }
+}
 
-    for (int64_t n = 0; n < list_size(bucket); ++n) {
-        tuple_t* pair = list_get(bucket, n);
+typedef struct map_parallel_job_t {
+    map_t* map;
+    map_fn* fn;
+    void* ctx;
+    int64_t old_count;
+} map_parallel_job_t;
+
+void map_foreach_parallel_range(int64_t start, int64_t end, void* ctx) {
+    map_parallel_job_t* job = ctx;
+    map_t* self = job->map;
 
-        if (string_equal(key, (string_t*) pair->first)) {
-            return pair->second;
+    if (self->engine == MAP_ENGINE_FLAT) {
+        for (int64_t n = start; n < end; ++n) {
+            if ((self->ctrl[n] & MAP_FLAT_EMPTY) == 0) {
+                job->fn(&self->slots[n].key, self->slots[n].value, job->ctx);
+            }
         }
+
+        return;
+    }
+
+    // the old buckets still being migrated come first in the index space.
+    for (int64_t n = start; n < end; ++n) {
+        list_t* buckets = n < job->old_count ? self->old_buckets : self->buckets;
+        list_t* bucket = list_get(buckets, n < job->old_count ? n : n - job->old_count);
+
+        for (int64_t p = 0; bucket != NULL && p < list_size(bucket); ++p) {
+            map_entry_t* entry = list_get(bucket, p);
+
+            job->fn(&entry->key, entry->value, job->ctx);
+        }
+    }
+}
+
+void map_foreach_parallel(map_t* self, map_fn fn, void* ctx, int64_t grain) {
+    thread_pool_t* pool = thread_pool_default();
+    map_parallel_job_t job = {
+        .map = self,
+        .fn = fn,
+        .ctx = ctx,
+        .old_count = self->old_buckets != NULL ? list_size(self->old_buckets) : 0,
+    };
+    int64_t count = self->engine == MAP_ENGINE_FLAT ? self->capacity : job.old_count + list_size(self->buckets);
+
+    if (grain <= 0) {
+        grain = crumb_max(count / (thread_pool_size(pool) * MAP_PARALLEL_CHUNKS_PER_THREAD), 1);
     }
 
-    return NULL;
+    thread_pool_for(pool, count, grain, map_foreach_parallel_range, &job);
 }
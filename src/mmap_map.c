@@ -0,0 +1,229 @@
+#include "mmap_map.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cstrings.h"
+#include "frozen_map.h"
+#include "map.h"
+
+int64_t mmap_map_align(int64_t offset) {
+    return (offset + 7) & ~(int64_t) 7;
+}
+
+bool mmap_map_write(FILE* file, void const* data, int64_t length) {
+    return length == 0 || fwrite(data, 1, length, file) == (size_t) length;
+}
+
+bool map_save(map_t* self, char const* path) {
+    frozen_map_t* frozen = map_freeze(self);
+
+    if (frozen == NULL) {
+        return false;
+    }
+
+    int64_t size = frozen->size;
+    mmap_map_slot_t* slots = malloc(sizeof(mmap_map_slot_t) * (size + 1));
+    int64_t data_length = 0;
+
+    for (int64_t position = 0; position < size; ++position) {
+        frozen_map_slot_t* slot = &frozen->slots[position];
+
+        slots[position].hash = slot->hash;
+        slots[position].offset = data_length;
+        slots[position].key_length = slot[1].offset - slot->offset;
+
+        data_length += slots[position].key_length + string_length(slot->value);
+    }
+    slots[size] = (mmap_map_slot_t) { .hash = 0, .offset = data_length, .key_length = 0 };
+
+    mmap_map_header_t header = {
+        .magic = MMAP_MAP_MAGIC,
+        .version = MMAP_MAP_VERSION,
+        .reserved = 0,
+        .seed = frozen->seed,
+        .size = size,
+        .bucket_count = frozen->bucket_count,
+        .pilots_offset = sizeof(mmap_map_header_t),
+    };
+    header.slots_offset = mmap_map_align(header.pilots_offset + sizeof(uint32_t) * header.bucket_count);
+    header.data_offset = header.slots_offset + sizeof(mmap_map_slot_t) * (size + 1);
+    header.data_length = data_length;
+
+    // readers may have the old file mapped, so the new one is written aside
+    // and renamed over it once complete, rather than truncated in place.
+    int64_t path_length = strlen(path);
+    char* temp_path = malloc(path_length + sizeof(".XXXXXX"));
+
+    memcpy(temp_path, path, path_length);
+    memcpy(temp_path + path_length, ".XXXXXX", sizeof(".XXXXXX"));
+
+    int fd = mkstemp(temp_path);
+    FILE* file = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    bool ok = file != NULL;
+    char const padding[8] = { 0 };
+    struct stat old;
+
+    // a replaced file keeps its permissions; a new one keeps those of mkstemp.
+    if (ok && stat(path, &old) == 0) {
+        ok = fchmod(fd, old.st_mode & 07777) == 0;
+    }
+
+    ok = ok && mmap_map_write(file, &header, sizeof(header));
+    ok = ok && mmap_map_write(file, frozen->pilots, sizeof(uint32_t) * header.bucket_count);
+    ok = ok && mmap_map_write(file, padding, header.slots_offset - header.pilots_offset - sizeof(uint32_t) * header.bucket_count);
+    ok = ok && mmap_map_write(file, slots, sizeof(mmap_map_slot_t) * (size + 1));
+
+    // each key is followed by its value, so a hit touches a single run of bytes.
+    for (int64_t position = 0; ok && position < size; ++position) {
+        frozen_map_slot_t* slot = &frozen->slots[position];
+
+        ok = mmap_map_write(file, frozen->blob + slot->offset, slots[position].key_length)
+            && mmap_map_write(file, string_data(slot->value), string_length(slot->value));
+    }
+
+    ok = ok && fflush(file) == 0 && fsync(fd) == 0;
+
+    if (file != NULL && fclose(file) != 0) {
+        ok = false;
+    } else if (file == NULL && fd >= 0) {
+        close(fd);
+    }
+
+    ok = ok && rename(temp_path, path) == 0;
+
+    if (!ok && fd >= 0) {
+        unlink(temp_path);
+    }
+
+    free(temp_path);
+    free(slots);
+    frozen_map_free(frozen);
+
+    return ok;
+}
+
+bool mmap_map_header_valid(mmap_map_header_t const* header, int64_t length) {
+    if (header->magic != MMAP_MAP_MAGIC || header->version != MMAP_MAP_VERSION) {
+        return false;
+    }
+
+    if (header->size < 0 || header->bucket_count < 1 || header->data_length < 0) {
+        return false;
+    }
+
+    // the offsets are ordered before they are subtracted, so no difference overflows.
+    return header->pilots_offset >= (int64_t) sizeof(mmap_map_header_t)
+        && header->pilots_offset <= header->slots_offset
+        && header->slots_offset <= header->data_offset
+        && header->data_offset <= length
+        && header->pilots_offset % sizeof(uint32_t) == 0
+        && header->slots_offset % sizeof(int64_t) == 0
+        && (header->slots_offset - header->pilots_offset) / (int64_t) sizeof(uint32_t) >= header->bucket_count
+        && header->size < (header->data_offset - header->slots_offset) / (int64_t) sizeof(mmap_map_slot_t)
+        && header->data_length <= length - header->data_offset;
+}
+
+// mmap_map_slots_valid checks that every key and value lies inside the data
+// section, so a corrupt file cannot make lookups read out of bounds.
+bool mmap_map_slots_valid(mmap_map_slot_t const* slots, mmap_map_header_t const* header) {
+    if (slots[0].offset < 0 || slots[header->size].offset != header->data_length) {
+        return false;
+    }
+
+    for (int64_t n = 0; n < header->size; ++n) {
+        if (slots[n].key_length < 0 || slots[n].key_length > slots[n + 1].offset - slots[n].offset) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+mmap_map_t* map_open_mmap(char const* path) {
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    void* data = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t) sizeof(mmap_map_header_t)) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    // the mapping keeps its own reference to the file.
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+
+    mmap_map_header_t const* header = data;
+
+    if (!mmap_map_header_valid(header, st.st_size)) {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    mmap_map_slot_t const* slots = (mmap_map_slot_t const*) ((char const*) data + header->slots_offset);
+
+    if (!mmap_map_slots_valid(slots, header)) {
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    // lookups land on random pages, so read-ahead would only waste page cache.
+    posix_madvise(data, st.st_size, POSIX_MADV_RANDOM);
+
+    mmap_map_t* self = malloc(sizeof(mmap_map_t));
+
+    self->data = data;
+    self->length = st.st_size;
+    self->pilots = (uint32_t const*) ((char const*) data + header->pilots_offset);
+    self->slots = slots;
+    self->blob = (char const*) data + header->data_offset;
+    self->size = header->size;
+    self->bucket_count = header->bucket_count;
+    self->seed = header->seed;
+
+    return self;
+}
+
+void mmap_map_close(mmap_map_t* self) {
+    munmap(self->data, self->length);
+    free(self);
+}
+
+char const* mmap_map_get(mmap_map_t* self, string_t* key, int64_t* length) {
+    if (self->size == 0) {
+        return NULL;
+    }
+
+    uint64_t hash = frozen_map_hash(self->seed, key);
+    uint32_t pilot = self->pilots[hash % self->bucket_count];
+    mmap_map_slot_t const* slot = &self->slots[frozen_map_position(hash, pilot, self->size)];
+
+    if (slot->hash != hash || slot->key_length != string_length(key)) {
+        return NULL;
+    }
+
+    if (memcmp(self->blob + slot->offset, string_data(key), slot->key_length) != 0) {
+        return NULL;
+    }
+
+    *length = slot[1].offset - slot->offset - slot->key_length;
+
+    return self->blob + slot->offset + slot->key_length;
+}
+
+int64_t mmap_map_size(mmap_map_t* self) {
+    return self->size;
+}
@@ -0,0 +1,397 @@
+#include "pmap.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cstrings.h"
+#include "map.h"
+
+#define PMAP_MASK ((1u << PMAP_BITS) - 1)
+
+pmap_node_t* pmap_node_retain(pmap_node_t* node) {
+    atomic_fetch_add_explicit(&node->refs, 1, memory_order_relaxed);
+
+    return node;
+}
+
+void pmap_node_release(pmap_node_t* node) {
+    if (node == NULL || atomic_fetch_sub_explicit(&node->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    if (node->kind == PMAP_BRANCH) {
+        pmap_branch_t* branch = (pmap_branch_t*) node;
+
+        for (int n = 0; n < __builtin_popcount(branch->bitmap); ++n) {
+            pmap_node_release(branch->children[n]);
+        }
+    } else if (node->kind == PMAP_COLLISION) {
+        pmap_collision_t* collision = (pmap_collision_t*) node;
+
+        for (int64_t n = 0; n < collision->count; ++n) {
+            pmap_node_release(&collision->leaves[n]->node);
+        }
+    }
+
+    free(node);
+}
+
+uint64_t pmap_node_hash(pmap_node_t* node) {
+    if (node->kind == PMAP_LEAF) {
+        return ((pmap_leaf_t*) node)->key.hash;
+    }
+
+    return ((pmap_collision_t*) node)->hash;
+}
+
+pmap_node_t* pmap_leaf_new(string_t* key, uint64_t hash, void* value) {
+    pmap_leaf_t* leaf = malloc(sizeof(pmap_leaf_t) + string_length(key));
+
+    atomic_init(&leaf->node.refs, 1);
+    leaf->node.kind = PMAP_LEAF;
+    leaf->key.buf = leaf->data;
+    leaf->key.length = string_length(key);
+    leaf->key.hash = hash;
+    leaf->value = value;
+    memcpy(leaf->data, string_data(key), string_length(key));
+
+    return &leaf->node;
+}
+
+pmap_branch_t* pmap_branch_new(uint32_t bitmap) {
+    pmap_branch_t* branch = malloc(sizeof(pmap_branch_t) + sizeof(pmap_node_t*) * __builtin_popcount(bitmap));
+
+    atomic_init(&branch->node.refs, 1);
+    branch->node.kind = PMAP_BRANCH;
+    branch->bitmap = bitmap;
+
+    return branch;
+}
+
+pmap_collision_t* pmap_collision_new(uint64_t hash, int64_t count) {
+    pmap_collision_t* collision = malloc(sizeof(pmap_collision_t) + sizeof(pmap_leaf_t*) * count);
+
+    atomic_init(&collision->node.refs, 1);
+    collision->node.kind = PMAP_COLLISION;
+    collision->hash = hash;
+    collision->count = count;
+
+    return collision;
+}
+
+// pmap_pair returns a branch holding two nodes whose hashes differ, nesting
+// branches for as many levels as their hashes agree on.
+pmap_node_t* pmap_pair(int shift, pmap_node_t* lhs, uint64_t lhs_hash, pmap_node_t* rhs, uint64_t rhs_hash) {
+    uint32_t lhs_chunk = (lhs_hash >> shift) & PMAP_MASK;
+    uint32_t rhs_chunk = (rhs_hash >> shift) & PMAP_MASK;
+
+    if (lhs_chunk == rhs_chunk) {
+        pmap_branch_t* branch = pmap_branch_new(1u << lhs_chunk);
+        branch->children[0] = pmap_pair(shift + PMAP_BITS, lhs, lhs_hash, rhs, rhs_hash);
+
+        return &branch->node;
+    }
+
+    pmap_branch_t* branch = pmap_branch_new((1u << lhs_chunk) | (1u << rhs_chunk));
+    branch->children[lhs_chunk < rhs_chunk ? 0 : 1] = lhs;
+    branch->children[lhs_chunk < rhs_chunk ? 1 : 0] = rhs;
+
+    return &branch->node;
+}
+
+// pmap_node_set returns a new reference to a node holding every pair under
+// node plus key, without modifying node.
+pmap_node_t* pmap_node_set(pmap_node_t* node, int shift, string_t* key, uint64_t hash, void* value, bool* added) {
+    *added = true;
+
+    if (node == NULL) {
+        return pmap_leaf_new(key, hash, value);
+    }
+
+    if (node->kind == PMAP_BRANCH) {
+        pmap_branch_t* branch = (pmap_branch_t*) node;
+        uint32_t bit = 1u << ((hash >> shift) & PMAP_MASK);
+        int index = __builtin_popcount(branch->bitmap & (bit - 1));
+        int count = __builtin_popcount(branch->bitmap);
+
+        if (branch->bitmap & bit) {
+            pmap_branch_t* copy = pmap_branch_new(branch->bitmap);
+
+            for (int n = 0; n < count; ++n) {
+                copy->children[n] = n == index ? NULL : pmap_node_retain(branch->children[n]);
+            }
+            copy->children[index] = pmap_node_set(branch->children[index], shift + PMAP_BITS, key, hash, value, added);
+
+            return &copy->node;
+        }
+
+        pmap_branch_t* copy = pmap_branch_new(branch->bitmap | bit);
+
+        for (int n = 0; n < count; ++n) {
+            copy->children[n < index ? n : n + 1] = pmap_node_retain(branch->children[n]);
+        }
+        copy->children[index] = pmap_leaf_new(key, hash, value);
+
+        return &copy->node;
+    }
+
+    uint64_t node_hash = pmap_node_hash(node);
+
+    if (node_hash != hash) {
+        return pmap_pair(shift, pmap_node_retain(node), node_hash, pmap_leaf_new(key, hash, value), hash);
+    }
+
+    if (node->kind == PMAP_LEAF) {
+        pmap_leaf_t* leaf = (pmap_leaf_t*) node;
+
+        if (string_equal(&leaf->key, key)) {
+            *added = false;
+
+            return pmap_leaf_new(key, hash, value);
+        }
+
+        pmap_collision_t* collision = pmap_collision_new(hash, 2);
+        collision->leaves[0] = (pmap_leaf_t*) pmap_node_retain(node);
+        collision->leaves[1] = (pmap_leaf_t*) pmap_leaf_new(key, hash, value);
+
+        return &collision->node;
+    }
+
+    pmap_collision_t* collision = (pmap_collision_t*) node;
+    int64_t index = collision->count;
+
+    for (int64_t n = 0; n < collision->count; ++n) {
+        if (string_equal(&collision->leaves[n]->key, key)) {
+            index = n;
+        }
+    }
+
+    *added = index == collision->count;
+
+    pmap_collision_t* copy = pmap_collision_new(hash, collision->count + *added);
+    for (int64_t n = 0; n < collision->count; ++n) {
+        copy->leaves[n] = n == index ? NULL : (pmap_leaf_t*) pmap_node_retain(&collision->leaves[n]->node);
+    }
+    copy->leaves[index] = (pmap_leaf_t*) pmap_leaf_new(key, hash, value);
+
+    return &copy->node;
+}
+
+// pmap_node_delete returns a new reference to a node holding every pair
+// under node except key, or NULL if none are left, without modifying node.
+pmap_node_t* pmap_node_delete(pmap_node_t* node, int shift, string_t* key, uint64_t hash, bool* removed) {
+    *removed = false;
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (node->kind == PMAP_LEAF) {
+        pmap_leaf_t* leaf = (pmap_leaf_t*) node;
+
+        if (leaf->key.hash == hash && string_equal(&leaf->key, key)) {
+            *removed = true;
+
+            return NULL;
+        }
+
+        return pmap_node_retain(node);
+    }
+
+    if (node->kind == PMAP_COLLISION) {
+        pmap_collision_t* collision = (pmap_collision_t*) node;
+        int64_t index = -1;
+
+        for (int64_t n = 0; collision->hash == hash && n < collision->count; ++n) {
+            if (string_equal(&collision->leaves[n]->key, key)) {
+                index = n;
+            }
+        }
+
+        if (index < 0) {
+            return pmap_node_retain(node);
+        }
+
+        *removed = true;
+
+        if (collision->count == 2) {
+            return pmap_node_retain(&collision->leaves[1 - index]->node);
+        }
+
+        pmap_collision_t* copy = pmap_collision_new(hash, collision->count - 1);
+        for (int64_t n = 0; n < collision->count; ++n) {
+            if (n != index) {
+                copy->leaves[n < index ? n : n - 1] = (pmap_leaf_t*) pmap_node_retain(&collision->leaves[n]->node);
+            }
+        }
+
+        return &copy->node;
+    }
+
+    pmap_branch_t* branch = (pmap_branch_t*) node;
+    uint32_t bit = 1u << ((hash >> shift) & PMAP_MASK);
+    int index = __builtin_popcount(branch->bitmap & (bit - 1));
+    int count = __builtin_popcount(branch->bitmap);
+
+    if ((branch->bitmap & bit) == 0) {
+        return pmap_node_retain(node);
+    }
+
+    pmap_node_t* child = pmap_node_delete(branch->children[index], shift + PMAP_BITS, key, hash, removed);
+
+    if (!*removed) {
+        pmap_node_release(child);
+
+        return pmap_node_retain(node);
+    }
+
+    // a branch left with a single leaf or collision is replaced by it, since
+    // lookups find either at any depth along its hash.
+    if (child == NULL) {
+        if (count == 1) {
+            return NULL;
+        }
+
+        if (count == 2 && branch->children[1 - index]->kind != PMAP_BRANCH) {
+            return pmap_node_retain(branch->children[1 - index]);
+        }
+
+        pmap_branch_t* copy = pmap_branch_new(branch->bitmap & ~bit);
+        for (int n = 0; n < count; ++n) {
+            if (n != index) {
+                copy->children[n < index ? n : n - 1] = pmap_node_retain(branch->children[n]);
+            }
+        }
+
+        return &copy->node;
+    }
+
+    if (count == 1 && child->kind != PMAP_BRANCH) {
+        return child;
+    }
+
+    pmap_branch_t* copy = pmap_branch_new(branch->bitmap);
+    for (int n = 0; n < count; ++n) {
+        copy->children[n] = n == index ? child : pmap_node_retain(branch->children[n]);
+    }
+
+    return &copy->node;
+}
+
+void pmap_node_foreach(pmap_node_t* node, map_fn fn, void* ctx) {
+    if (node == NULL) {
+        return;
+    }
+
+    if (node->kind == PMAP_LEAF) {
+        pmap_leaf_t* leaf = (pmap_leaf_t*) node;
+
+        fn(&leaf->key, leaf->value, ctx);
+    } else if (node->kind == PMAP_COLLISION) {
+        pmap_collision_t* collision = (pmap_collision_t*) node;
+
+        for (int64_t n = 0; n < collision->count; ++n) {
+            fn(&collision->leaves[n]->key, collision->leaves[n]->value, ctx);
+        }
+    } else {
+        pmap_branch_t* branch = (pmap_branch_t*) node;
+
+        for (int n = 0; n < __builtin_popcount(branch->bitmap); ++n) {
+            pmap_node_foreach(branch->children[n], fn, ctx);
+        }
+    }
+}
+
+pmap_t* pmap_version(pmap_node_t* root, int64_t size) {
+    pmap_t* self = malloc(sizeof(pmap_t));
+
+    atomic_init(&self->refs, 1);
+    self->root = root;
+    self->size = size;
+
+    return self;
+}
+
+pmap_t* pmap_new(void) {
+    return pmap_version(NULL, 0);
+}
+
+pmap_t* pmap_snapshot(pmap_t* self) {
+    atomic_fetch_add_explicit(&self->refs, 1, memory_order_relaxed);
+
+    return self;
+}
+
+void pmap_free(pmap_t* self) {
+    if (atomic_fetch_sub_explicit(&self->refs, 1, memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    pmap_node_release(self->root);
+    free(self);
+}
+
+pmap_t* pmap_set(pmap_t* self, string_t* key, void* value) {
+    bool added;
+    pmap_node_t* root = pmap_node_set(self->root, 0, key, string_hash(key), value, &added);
+
+    return pmap_version(root, self->size + added);
+}
+
+pmap_t* pmap_delete(pmap_t* self, string_t* key) {
+    bool removed;
+    pmap_node_t* root = pmap_node_delete(self->root, 0, key, string_hash(key), &removed);
+
+    if (!removed) {
+        pmap_node_release(root);
+
+        return pmap_snapshot(self);
+    }
+
+    return pmap_version(root, self->size - 1);
+}
+
+void* pmap_get(pmap_t* self, string_t* key) {
+    uint64_t hash = string_hash(key);
+    pmap_node_t* node = self->root;
+
+    for (int shift = 0; node != NULL && node->kind == PMAP_BRANCH; shift += PMAP_BITS) {
+        pmap_branch_t* branch = (pmap_branch_t*) node;
+        uint32_t bit = 1u << ((hash >> shift) & PMAP_MASK);
+
+        if ((branch->bitmap & bit) == 0) {
+            return NULL;
+        }
+
+        node = branch->children[__builtin_popcount(branch->bitmap & (bit - 1))];
+    }
+
+    if (node == NULL) {
+        return NULL;
+    }
+
+    if (node->kind == PMAP_LEAF) {
+        pmap_leaf_t* leaf = (pmap_leaf_t*) node;
+
+        return leaf->key.hash == hash && string_equal(&leaf->key, key) ? leaf->value : NULL;
+    }
+
+    pmap_collision_t* collision = (pmap_collision_t*) node;
+
+    for (int64_t n = 0; collision->hash == hash && n < collision->count; ++n) {
+        if (string_equal(&collision->leaves[n]->key, key)) {
+            return collision->leaves[n]->value;
+        }
+    }
+
+    return NULL;
+}
+
+int64_t pmap_size(pmap_t* self) {
+    return self->size;
+}
+
+void pmap_foreach(pmap_t* self, map_fn fn, void* ctx) {
+    pmap_node_foreach(self->root, fn, ctx);
+}
@@ -0,0 +1,310 @@
+#include "rcu_map.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "cstrings.h"
+#include "list.h"
+#include "tuple.h"
+
+void rcu_map_pair_free_fn(void* elem) {
+    tuple_t* self = (tuple_t*) elem;
+
+    string_free(self->first);
+    tuple_free(self);
+}
+
+void rcu_map_tuple_free_fn(void* elem) {
+    tuple_free((tuple_t*) elem);
+}
+
+void rcu_map_bucket_free_fn(void* elem) {
+    list_free((list_t*) elem);
+}
+
+void rcu_map_table_free_fn(void* elem) {
+    rcu_map_table_t* self = (rcu_map_table_t*) elem;
+
+    for (int64_t n = 0; n < self->bucket_count; ++n) {
+        list_t* bucket = atomic_load(&self->buckets[n]);
+
+        if (bucket != NULL) {
+            list_free(bucket);
+        }
+    }
+
+    free(self->buckets);
+    free(self);
+}
+
+rcu_map_table_t* rcu_map_table_new(int64_t bucket_count) {
+    rcu_map_table_t* self = malloc(sizeof(rcu_map_table_t));
+    self->bucket_count = bucket_count;
+    self->buckets = malloc(sizeof(_Atomic(list_t*)) * bucket_count);
+
+    for (int64_t n = 0; n < bucket_count; ++n) {
+        atomic_init(&self->buckets[n], NULL);
+    }
+
+    return self;
+}
+
+int64_t rcu_map_find(list_t* bucket, uint64_t hash, string_t* key) {
+    if (bucket == NULL) {
+        return -1;
+    }
+
+    for (int64_t n = 0; n < list_size(bucket); ++n) {
+        tuple_t* pair = list_get(bucket, n);
+
+        // stored keys always carry their hash, and callers hash with
+        // string_hash_uncached, so lookups never write to a shared key.
+        if (((string_t*) pair->first)->hash == hash && string_equal(key, (string_t*) pair->first)) {
+            return n;
+        }
+    }
+
+    return -1;
+}
+
+void rcu_map_retire(rcu_map_t* self, void* ptr, void (*free_fn)(void*)) {
+    rcu_map_retired_t* retired = malloc(sizeof(rcu_map_retired_t));
+    retired->ptr = ptr;
+    retired->free_fn = free_fn;
+    retired->epoch = atomic_load(&self->epoch);
+    retired->next = self->retired;
+
+    self->retired = retired;
+}
+
+int64_t rcu_map_reclaim_locked(rcu_map_t* self) {
+    uint64_t min_epoch = UINT64_MAX;
+
+    for (rcu_map_reader_t* reader = self->readers; reader != NULL; reader = reader->next) {
+        uint64_t epoch = atomic_load(&reader->epoch);
+
+        if (epoch < min_epoch) {
+            min_epoch = epoch;
+        }
+    }
+
+    // memory retired at epoch e was unpublished before the epoch became
+    // e + 1, so readers that have since observed e + 1 cannot reach it.
+    int64_t pending = 0;
+    rcu_map_retired_t** link = &self->retired;
+
+    while (*link != NULL) {
+        rcu_map_retired_t* retired = *link;
+
+        if (retired->epoch < min_epoch) {
+            *link = retired->next;
+            retired->free_fn(retired->ptr);
+            free(retired);
+        } else {
+            link = &retired->next;
+            ++pending;
+        }
+    }
+
+    return pending;
+}
+
+void rcu_map_publish(rcu_map_t* self, rcu_map_table_t* table, int64_t index, list_t* bucket) {
+    list_t* old = atomic_exchange(&table->buckets[index], bucket);
+
+    if (old != NULL) {
+        rcu_map_retire(self, old, rcu_map_bucket_free_fn);
+    }
+}
+
+void rcu_map_grow(rcu_map_t* self) {
+    rcu_map_table_t* table = atomic_load(&self->table);
+    rcu_map_table_t* grown = rcu_map_table_new(table->bucket_count * 2);
+
+    for (int64_t b = 0; b < table->bucket_count; ++b) {
+        list_t* bucket = atomic_load(&table->buckets[b]);
+
+        for (int64_t p = 0; bucket != NULL && p < list_size(bucket); ++p) {
+            tuple_t* pair = list_get(bucket, p);
+            int64_t index = ((string_t*) pair->first)->hash % grown->bucket_count;
+            list_t* target = atomic_load(&grown->buckets[index]);
+
+            if (target == NULL) {
+                target = list_new(1);
+            }
+
+            atomic_store(&grown->buckets[index], list_append(target, pair));
+        }
+    }
+
+    // pairs move to the new table as-is, so only the buckets are retired.
+    atomic_store(&self->table, grown);
+    rcu_map_retire(self, table, rcu_map_table_free_fn);
+}
+
+void rcu_map_end_write(rcu_map_t* self) {
+    atomic_fetch_add(&self->epoch, 1);
+    rcu_map_reclaim_locked(self);
+    pthread_mutex_unlock(&self->writer);
+}
+
+rcu_map_t* rcu_map_new(int64_t bucket_count) {
+    rcu_map_t* self = malloc(sizeof(rcu_map_t));
+
+    atomic_init(&self->table, rcu_map_table_new(bucket_count > 0 ? bucket_count : 1));
+    atomic_init(&self->epoch, 0);
+    pthread_mutex_init(&self->writer, NULL);
+    self->readers = NULL;
+    self->retired = NULL;
+    self->size = 0;
+
+    return self;
+}
+
+void rcu_map_free(rcu_map_t* self) {
+    rcu_map_table_t* table = atomic_load(&self->table);
+
+    for (int64_t n = 0; n < table->bucket_count; ++n) {
+        list_t* bucket = atomic_load(&table->buckets[n]);
+
+        if (bucket != NULL) {
+            list_foreach(bucket, rcu_map_pair_free_fn);
+        }
+    }
+    rcu_map_table_free_fn(table);
+
+    while (self->retired != NULL) {
+        rcu_map_retired_t* retired = self->retired;
+        self->retired = retired->next;
+
+        retired->free_fn(retired->ptr);
+        free(retired);
+    }
+
+    while (self->readers != NULL) {
+        rcu_map_reader_t* reader = self->readers;
+        self->readers = reader->next;
+
+        free(reader);
+    }
+
+    pthread_mutex_destroy(&self->writer);
+    free(self);
+}
+
+rcu_map_reader_t* rcu_map_reader_register(rcu_map_t* self) {
+    rcu_map_reader_t* reader = malloc(sizeof(rcu_map_reader_t));
+
+    pthread_mutex_lock(&self->writer);
+    atomic_init(&reader->epoch, atomic_load(&self->epoch));
+    reader->next = self->readers;
+    self->readers = reader;
+    pthread_mutex_unlock(&self->writer);
+
+    return reader;
+}
+
+void rcu_map_reader_unregister(rcu_map_t* self, rcu_map_reader_t* reader) {
+    pthread_mutex_lock(&self->writer);
+
+    for (rcu_map_reader_t** link = &self->readers; *link != NULL; link = &(*link)->next) {
+        if (*link == reader) {
+            *link = reader->next;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&self->writer);
+    free(reader);
+}
+
+void rcu_map_quiescent(rcu_map_t* self, rcu_map_reader_t* reader) {
+    atomic_store(&reader->epoch, atomic_load(&self->epoch));
+}
+
+rcu_map_t* rcu_map_set(rcu_map_t* self, string_t* key, void* value) {
+    uint64_t hash = string_hash_uncached(key);
+
+    pthread_mutex_lock(&self->writer);
+
+    rcu_map_table_t* table = atomic_load(&self->table);
+    int64_t index = hash % table->bucket_count;
+    list_t* bucket = atomic_load(&table->buckets[index]);
+    int64_t found = rcu_map_find(bucket, hash, key);
+    list_t* copy = bucket != NULL ? list_copy(bucket) : list_new(1);
+
+    if (found >= 0) {
+        // the key is immutable, so the new pair shares it with the old one.
+        tuple_t* pair = list_get(bucket, found);
+
+        list_set(copy, found, tuple_new(pair->first, value));
+        rcu_map_publish(self, table, index, copy);
+        rcu_map_retire(self, pair, rcu_map_tuple_free_fn);
+    } else {
+        string_t* owned = string_copy(key);
+        owned->hash = hash;
+
+        rcu_map_publish(self, table, index, list_append(copy, tuple_new(owned, value)));
+
+        if (++self->size > table->bucket_count) {
+            rcu_map_grow(self);
+        }
+    }
+
+    rcu_map_end_write(self);
+
+    return self;
+}
+
+void* rcu_map_delete(rcu_map_t* self, string_t* key) {
+    uint64_t hash = string_hash_uncached(key);
+
+    pthread_mutex_lock(&self->writer);
+
+    rcu_map_table_t* table = atomic_load(&self->table);
+    int64_t index = hash % table->bucket_count;
+    list_t* bucket = atomic_load(&table->buckets[index]);
+    int64_t found = rcu_map_find(bucket, hash, key);
+    void* elem = NULL;
+
+    if (found >= 0) {
+        list_t* copy = list_copy(bucket);
+        tuple_t* pair = list_pop(copy, found);
+        elem = pair->second;
+
+        if (list_size(copy) == 0) {
+            list_free(copy);
+            copy = NULL;
+        }
+
+        rcu_map_publish(self, table, index, copy);
+        rcu_map_retire(self, pair, rcu_map_pair_free_fn);
+        --self->size;
+    }
+
+    rcu_map_end_write(self);
+
+    return elem;
+}
+
+void* rcu_map_get(rcu_map_t* self, string_t* key) {
+    uint64_t hash = string_hash_uncached(key);
+    rcu_map_table_t* table = atomic_load_explicit(&self->table, memory_order_acquire);
+    list_t* bucket = atomic_load_explicit(&table->buckets[hash % table->bucket_count], memory_order_acquire);
+    int64_t index = rcu_map_find(bucket, hash, key);
+
+    if (index < 0) {
+        return NULL;
+    }
+
+    return ((tuple_t*) list_get(bucket, index))->second;
+}
+
+int64_t rcu_map_reclaim(rcu_map_t* self) {
+    pthread_mutex_lock(&self->writer);
+    int64_t pending = rcu_map_reclaim_locked(self);
+    pthread_mutex_unlock(&self->writer);
+
+    return pending;
+}
@@ -0,0 +1,252 @@
+#include "set.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "cstrings.h"
+#include "math.h"
+
+#define SET_ARENA_CHUNK_SIZE 65536
+#define SET_MIN_CAPACITY 16
+
+// linear probing stays short while the set is at most 3/4 full.
+#define SET_MAX_LOAD_NUM 3
+#define SET_MAX_LOAD_DEN 4
+
+void set_alloc(set_t* self, int64_t capacity) {
+    self->capacity = capacity;
+    self->slots = calloc(capacity, sizeof(string_t));
+}
+
+int64_t set_find(set_t const* self, uint64_t hash, char const* data, int64_t length) {
+    int64_t mask = self->capacity - 1;
+
+    // returns the slot holding the key, or the empty slot ending its probe.
+    for (int64_t index = hash & mask;; index = (index + 1) & mask) {
+        string_t const* slot = &self->slots[index];
+
+        if (slot->buf == NULL) {
+            return index;
+        }
+
+        if (slot->hash == hash && slot->length == length && memcmp(slot->buf, data, length) == 0) {
+            return index;
+        }
+    }
+}
+
+void set_grow(set_t* self) {
+    string_t* old_slots = self->slots;
+    int64_t old_capacity = self->capacity;
+
+    set_alloc(self, old_capacity * 2);
+
+    int64_t mask = self->capacity - 1;
+    for (int64_t n = 0; n < old_capacity; ++n) {
+        if (old_slots[n].buf == NULL) {
+            continue;
+        }
+
+        int64_t index = old_slots[n].hash & mask;
+        while (self->slots[index].buf != NULL) {
+            index = (index + 1) & mask;
+        }
+        self->slots[index] = old_slots[n];
+    }
+
+    free(old_slots);
+}
+
+bool set_add_hashed(set_t* self, char const* data, int64_t length, uint64_t hash) {
+    int64_t index = set_find(self, hash, data, length);
+
+    if (self->slots[index].buf != NULL) {
+        return false;
+    }
+
+    // zero length keys still get a buffer, since a NULL buffer marks an empty slot.
+    string_t* slot = &self->slots[index];
+    slot->buf = arena_alloc(self->arena, crumb_max(length, 1));
+    slot->length = length;
+    slot->hash = hash;
+    memcpy(slot->buf, data, length);
+
+    if (++self->size * SET_MAX_LOAD_DEN > self->capacity * SET_MAX_LOAD_NUM) {
+        set_grow(self);
+    }
+
+    return true;
+}
+
+bool set_remove_hashed(set_t* self, char const* data, int64_t length, uint64_t hash) {
+    int64_t index = set_find(self, hash, data, length);
+
+    if (self->slots[index].buf == NULL) {
+        return false;
+    }
+
+    arena_release(self->arena, self->slots[index].buf, crumb_max(length, 1));
+    --self->size;
+
+    // shift back every later key whose probe passed through the freed slot.
+    int64_t mask = self->capacity - 1;
+    for (int64_t next = (index + 1) & mask; self->slots[next].buf != NULL; next = (next + 1) & mask) {
+        int64_t home = self->slots[next].hash & mask;
+
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            self->slots[index] = self->slots[next];
+            index = next;
+        }
+    }
+    self->slots[index].buf = NULL;
+
+    return true;
+}
+
+set_t* set_new(int64_t capacity) {
+    set_t* self = malloc(sizeof(set_t));
+
+    int64_t slots = SET_MIN_CAPACITY;
+    while (slots * SET_MAX_LOAD_NUM < capacity * SET_MAX_LOAD_DEN) {
+        slots *= 2;
+    }
+
+    set_alloc(self, slots);
+    self->size = 0;
+    self->arena = arena_new(SET_ARENA_CHUNK_SIZE);
+
+    return self;
+}
+
+set_t* set_copy(set_t* self) {
+    set_t* other = malloc(sizeof(set_t));
+
+    // slots keep their positions, so only the key data needs copying.
+    other->capacity = self->capacity;
+    other->size = self->size;
+    other->slots = malloc(sizeof(string_t) * self->capacity);
+    other->arena = arena_new(SET_ARENA_CHUNK_SIZE);
+    memcpy(other->slots, self->slots, sizeof(string_t) * self->capacity);
+
+    for (int64_t n = 0; n < other->capacity; ++n) {
+        string_t* slot = &other->slots[n];
+
+        if (slot->buf != NULL) {
+            char* buf = arena_alloc(other->arena, crumb_max(slot->length, 1));
+
+            memcpy(buf, slot->buf, slot->length);
+            slot->buf = buf;
+        }
+    }
+
+    return other;
+}
+
+void set_free(set_t* self) {
+    free(self->slots);
+    arena_free(self->arena);
+    free(self);
+}
+
+set_t* set_clear(set_t* self) {
+    memset(self->slots, 0, sizeof(string_t) * self->capacity);
+    arena_clear(self->arena);
+    self->size = 0;
+
+    return self;
+}
+
+bool set_add(set_t* self, string_t* key) {
+    return set_add_hashed(self, string_data(key), string_length(key), string_hash(key));
+}
+
+bool set_contains(set_t* self, string_t* key) {
+    int64_t index = set_find(self, string_hash(key), string_data(key), string_length(key));
+
+    return self->slots[index].buf != NULL;
+}
+
+bool set_remove(set_t* self, string_t* key) {
+    return set_remove_hashed(self, string_data(key), string_length(key), string_hash(key));
+}
+
+int64_t set_size(set_t* self) {
+    return self->size;
+}
+
+set_t* set_union(set_t* lhs, set_t* rhs) {
+    set_t* larger = lhs->size >= rhs->size ? lhs : rhs;
+    set_t* smaller = larger == lhs ? rhs : lhs;
+    set_t* other = set_copy(larger);
+
+    for (set_iter_t iter = set_iter(smaller); set_iter_next(&iter);) {
+        set_add_hashed(other, iter.key->buf, iter.key->length, iter.key->hash);
+    }
+
+    return other;
+}
+
+set_t* set_intersect(set_t* lhs, set_t* rhs) {
+    set_t* larger = lhs->size >= rhs->size ? lhs : rhs;
+    set_t* smaller = larger == lhs ? rhs : lhs;
+    set_t* other = set_new(smaller->size);
+
+    for (set_iter_t iter = set_iter(smaller); set_iter_next(&iter);) {
+        string_t* key = iter.key;
+
+        if (larger->slots[set_find(larger, key->hash, key->buf, key->length)].buf != NULL) {
+            set_add_hashed(other, key->buf, key->length, key->hash);
+        }
+    }
+
+    return other;
+}
+
+set_t* set_difference(set_t* lhs, set_t* rhs) {
+    if (rhs->size < lhs->size) {
+        set_t* other = set_copy(lhs);
+
+        for (set_iter_t iter = set_iter(rhs); set_iter_next(&iter);) {
+            set_remove_hashed(other, iter.key->buf, iter.key->length, iter.key->hash);
+        }
+
+        return other;
+    }
+
+    set_t* other = set_new(lhs->size);
+
+    for (set_iter_t iter = set_iter(lhs); set_iter_next(&iter);) {
+        string_t* key = iter.key;
+
+        if (rhs->slots[set_find(rhs, key->hash, key->buf, key->length)].buf == NULL) {
+            set_add_hashed(other, key->buf, key->length, key->hash);
+        }
+    }
+
+    return other;
+}
+
+set_iter_t set_iter(set_t* self) {
+    set_iter_t iter = {
+        .set = self,
+        .slot = -1,
+        .key = NULL,
+    };
+
+    return iter;
+}
+
+bool set_iter_next(set_iter_t* iter) {
+    set_t* self = iter->set;
+
+    while (++iter->slot < self->capacity) {
+        if (self->slots[iter->slot].buf != NULL) {
+            iter->key = &self->slots[iter->slot];
+
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,110 @@
+#include "string_intern.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "xxhash.h"
+
+#include "arena.h"
+#include "cstrings.h"
+#include "math.h"
+
+#define STRING_INTERN_ARENA_CHUNK_SIZE 65536
+#define STRING_INTERN_MIN_CAPACITY 16
+
+string_intern_t* string_intern_new(int64_t capacity) {
+    string_intern_t* self = malloc(sizeof(string_intern_t));
+
+    // keep the load factor at or below 1/2 for short linear probes.
+    self->capacity = STRING_INTERN_MIN_CAPACITY;
+    while (self->capacity < capacity * 2) {
+        self->capacity *= 2;
+    }
+
+    self->slots = calloc(self->capacity, sizeof(string_t*));
+    self->size = 0;
+    self->arena = arena_new(STRING_INTERN_ARENA_CHUNK_SIZE);
+
+    return self;
+}
+
+void string_intern_free(string_intern_t* self) {
+    free(self->slots);
+    arena_free(self->arena);
+    free(self);
+}
+
+int64_t string_intern_find(string_intern_t* self, uint64_t hash, char const* str, int64_t length) {
+    int64_t mask = self->capacity - 1;
+
+    for (int64_t index = hash & mask;; index = (index + 1) & mask) {
+        string_t* slot = self->slots[index];
+
+        if (slot == NULL) {
+            return index;
+        }
+
+        if (slot->hash == hash && slot->length == length && memcmp(slot->buf, str, length) == 0) {
+            return index;
+        }
+    }
+}
+
+void string_intern_grow(string_intern_t* self) {
+    string_t** slots = self->slots;
+    int64_t capacity = self->capacity;
+
+    self->capacity *= 2;
+    self->slots = calloc(self->capacity, sizeof(string_t*));
+
+    int64_t mask = self->capacity - 1;
+    for (int64_t n = 0; n < capacity; ++n) {
+        if (slots[n] == NULL) {
+            continue;
+        }
+
+        int64_t index = slots[n]->hash & mask;
+        while (self->slots[index] != NULL) {
+            index = (index + 1) & mask;
+        }
+        self->slots[index] = slots[n];
+    }
+
+    free(slots);
+}
+
+string_t* string_intern_hashed(string_intern_t* self, char const* str, int64_t length, uint64_t hash) {
+    int64_t index = string_intern_find(self, hash, str, length);
+
+    if (self->slots[index] != NULL) {
+        return self->slots[index];
+    }
+
+    // the string and its data share one block.
+    string_t* interned = arena_alloc(self->arena, sizeof(string_t) + crumb_max(length, 1));
+    interned->buf = (char*) (interned + 1);
+    interned->length = length;
+    interned->hash = hash;
+    memcpy(interned->buf, str, length);
+
+    self->slots[index] = interned;
+    ++self->size;
+
+    if (self->size * 2 > self->capacity) {
+        string_intern_grow(self);
+    }
+
+    return interned;
+}
+
+string_t* string_intern(string_intern_t* self, char const* str, int64_t length) {
+    return string_intern_hashed(self, str, length, XXH64(str, length, CRUMB_STRING_SEED));
+}
+
+string_t* string_intern_string(string_intern_t* self, string_t* str) {
+    return string_intern_hashed(self, string_data(str), string_length(str), string_hash(str));
+}
+
+int64_t string_intern_size(string_intern_t* self) {
+    return self->size;
+}
@@ -0,0 +1,200 @@
+#include "thread_pool.h"
+
+#include <pthread.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "math.h"
+
+#define THREAD_POOL_CACHE_LINE 64
+
+// each range sits on its own cache line, since every claim writes to it.
+typedef struct thread_pool_range_t {
+    alignas(THREAD_POOL_CACHE_LINE) _Atomic int64_t next;
+    int64_t end;
+} thread_pool_range_t;
+
+struct thread_pool_job_t {
+    thread_pool_range_fn* fn;
+    void* ctx;
+    int64_t size;
+    int64_t grain;
+    int64_t range_count;
+    thread_pool_range_t* ranges;
+};
+
+// set while a thread runs chunks, so nested loops run inline.
+static _Thread_local bool thread_pool_inside = false;
+
+static pthread_once_t thread_pool_default_once = PTHREAD_ONCE_INIT;
+static thread_pool_t* thread_pool_default_pool = NULL;
+
+// thread_pool_work runs the chunks of range index, then steals from the
+// ranges after it.
+void thread_pool_work(thread_pool_job_t* job, int64_t index) {
+    thread_pool_inside = true;
+
+    for (int64_t n = 0; n < job->range_count; ++n) {
+        thread_pool_range_t* range = &job->ranges[(index + n) % job->range_count];
+
+        for (int64_t chunk; (chunk = atomic_fetch_add_explicit(&range->next, 1, memory_order_relaxed)) < range->end;) {
+            int64_t start = chunk * job->grain;
+
+            job->fn(start, crumb_min(start + job->grain, job->size), job->ctx);
+        }
+    }
+
+    thread_pool_inside = false;
+}
+
+typedef struct thread_pool_worker_t {
+    thread_pool_t* pool;
+    int64_t index;
+} thread_pool_worker_t;
+
+void* thread_pool_worker(void* arg) {
+    thread_pool_worker_t worker = *(thread_pool_worker_t*) arg;
+    thread_pool_t* self = worker.pool;
+    uint64_t seen = 0;
+
+    free(arg);
+    pthread_mutex_lock(&self->lock);
+
+    while (!self->stop) {
+        if (self->generation == seen) {
+            pthread_cond_wait(&self->wake, &self->lock);
+            continue;
+        }
+
+        seen = self->generation;
+        thread_pool_job_t* job = self->job;
+
+        pthread_mutex_unlock(&self->lock);
+        thread_pool_work(job, worker.index);
+        pthread_mutex_lock(&self->lock);
+
+        if (--self->busy == 0) {
+            pthread_cond_signal(&self->done);
+        }
+    }
+
+    pthread_mutex_unlock(&self->lock);
+
+    return NULL;
+}
+
+thread_pool_t* thread_pool_new(int64_t thread_count) {
+    thread_pool_t* self = malloc(sizeof(thread_pool_t));
+
+    if (thread_count <= 0) {
+        thread_count = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+
+    self->thread_count = crumb_max(thread_count - 1, 0);
+    self->threads = malloc(sizeof(pthread_t) * crumb_max(self->thread_count, 1));
+    self->job = NULL;
+    self->generation = 0;
+    self->busy = 0;
+    self->stop = false;
+
+    pthread_mutex_init(&self->lock, NULL);
+    pthread_cond_init(&self->wake, NULL);
+    pthread_cond_init(&self->done, NULL);
+    pthread_mutex_init(&self->submit, NULL);
+
+    // the calling thread works on range 0, so workers start at 1.
+    for (int64_t n = 0; n < self->thread_count; ++n) {
+        thread_pool_worker_t* worker = malloc(sizeof(thread_pool_worker_t));
+
+        *worker = (thread_pool_worker_t) { .pool = self, .index = n + 1 };
+        pthread_create(&self->threads[n], NULL, thread_pool_worker, worker);
+    }
+
+    return self;
+}
+
+void thread_pool_free(thread_pool_t* self) {
+    pthread_mutex_lock(&self->lock);
+    self->stop = true;
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->lock);
+
+    for (int64_t n = 0; n < self->thread_count; ++n) {
+        pthread_join(self->threads[n], NULL);
+    }
+
+    pthread_mutex_destroy(&self->lock);
+    pthread_cond_destroy(&self->wake);
+    pthread_cond_destroy(&self->done);
+    pthread_mutex_destroy(&self->submit);
+    free(self->threads);
+    free(self);
+}
+
+void thread_pool_default_init(void) {
+    thread_pool_default_pool = thread_pool_new(0);
+}
+
+thread_pool_t* thread_pool_default(void) {
+    pthread_once(&thread_pool_default_once, thread_pool_default_init);
+
+    return thread_pool_default_pool;
+}
+
+int64_t thread_pool_size(thread_pool_t* self) {
+    return self->thread_count + 1;
+}
+
+void thread_pool_for(thread_pool_t* self, int64_t size, int64_t grain, thread_pool_range_fn fn, void* ctx) {
+    grain = crumb_max(grain, 1);
+
+    int64_t chunks = (size + grain - 1) / grain;
+
+    if (chunks <= 1 || self->thread_count == 0 || thread_pool_inside) {
+        for (int64_t start = 0; start < size; start += grain) {
+            fn(start, crumb_min(start + grain, size), ctx);
+        }
+
+        return;
+    }
+
+    int64_t range_count = thread_pool_size(self);
+    thread_pool_range_t* ranges = aligned_alloc(THREAD_POOL_CACHE_LINE, sizeof(thread_pool_range_t) * range_count);
+    thread_pool_job_t job = {
+        .fn = fn,
+        .ctx = ctx,
+        .size = size,
+        .grain = grain,
+        .range_count = range_count,
+        .ranges = ranges,
+    };
+
+    for (int64_t n = 0; n < range_count; ++n) {
+        atomic_init(&ranges[n].next, chunks * n / range_count);
+        ranges[n].end = chunks * (n + 1) / range_count;
+    }
+
+    pthread_mutex_lock(&self->submit);
+
+    pthread_mutex_lock(&self->lock);
+    self->job = &job;
+    self->busy = self->thread_count;
+    ++self->generation;
+    pthread_cond_broadcast(&self->wake);
+    pthread_mutex_unlock(&self->lock);
+
+    thread_pool_work(&job, 0);
+
+    pthread_mutex_lock(&self->lock);
+    while (self->busy > 0) {
+        pthread_cond_wait(&self->done, &self->lock);
+    }
+    self->job = NULL;
+    pthread_mutex_unlock(&self->lock);
+
+    pthread_mutex_unlock(&self->submit);
+
+    free(ranges);
+}
@@ -0,0 +1,150 @@
+#include "u64map.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "math.h"
+
+#define U64MAP_MIN_CAPACITY 16
+
+// linear probing stays short while the map is at most 3/4 full.
+#define U64MAP_MAX_LOAD_NUM 3
+#define U64MAP_MAX_LOAD_DEN 4
+
+int64_t u64map_find(u64map_t const* self, uint64_t key) {
+    int64_t mask = self->capacity - 1;
+
+    // returns the slot holding the key, or the empty slot ending its probe.
+    for (int64_t index = crumb_mix64(key) & mask;; index = (index + 1) & mask) {
+        uint64_t slot_key = self->slots[index].key;
+
+        if (slot_key == key || slot_key == 0) {
+            return index;
+        }
+    }
+}
+
+void u64map_grow(u64map_t* self) {
+    u64map_slot_t* old_slots = self->slots;
+    int64_t old_capacity = self->capacity;
+
+    self->capacity *= 2;
+    self->slots = calloc(self->capacity, sizeof(u64map_slot_t));
+
+    for (int64_t n = 0; n < old_capacity; ++n) {
+        if (old_slots[n].key != 0) {
+            self->slots[u64map_find(self, old_slots[n].key)] = old_slots[n];
+        }
+    }
+
+    free(old_slots);
+}
+
+u64map_t* u64map_new(int64_t capacity) {
+    u64map_t* self = malloc(sizeof(u64map_t));
+
+    self->capacity = U64MAP_MIN_CAPACITY;
+    while (self->capacity * U64MAP_MAX_LOAD_NUM < capacity * U64MAP_MAX_LOAD_DEN) {
+        self->capacity *= 2;
+    }
+
+    self->slots = calloc(self->capacity, sizeof(u64map_slot_t));
+    self->size = 0;
+    self->has_zero = false;
+    self->zero_value = NULL;
+
+    return self;
+}
+
+void u64map_free(u64map_t* self) {
+    free(self->slots);
+    free(self);
+}
+
+u64map_t* u64map_clear(u64map_t* self) {
+    memset(self->slots, 0, sizeof(u64map_slot_t) * self->capacity);
+    self->size = 0;
+    self->has_zero = false;
+    self->zero_value = NULL;
+
+    return self;
+}
+
+u64map_t* u64map_set(u64map_t* self, uint64_t key, void* value) {
+    if (key == 0) {
+        self->size += !self->has_zero;
+        self->has_zero = true;
+        self->zero_value = value;
+
+        return self;
+    }
+
+    u64map_slot_t* slot = &self->slots[u64map_find(self, key)];
+    slot->value = value;
+
+    if (slot->key == 0) {
+        slot->key = key;
+
+        if (++self->size * U64MAP_MAX_LOAD_DEN > self->capacity * U64MAP_MAX_LOAD_NUM) {
+            u64map_grow(self);
+        }
+    }
+
+    return self;
+}
+
+void* u64map_get(u64map_t* self, uint64_t key) {
+    if (key == 0) {
+        return self->zero_value;
+    }
+
+    u64map_slot_t* slot = &self->slots[u64map_find(self, key)];
+
+    return slot->key != 0 ? slot->value : NULL;
+}
+
+bool u64map_contains(u64map_t* self, uint64_t key) {
+    if (key == 0) {
+        return self->has_zero;
+    }
+
+    return self->slots[u64map_find(self, key)].key != 0;
+}
+
+void* u64map_delete(u64map_t* self, uint64_t key) {
+    if (key == 0) {
+        void* value = self->zero_value;
+
+        self->size -= self->has_zero;
+        self->has_zero = false;
+        self->zero_value = NULL;
+
+        return value;
+    }
+
+    int64_t index = u64map_find(self, key);
+    void* value = self->slots[index].value;
+
+    if (self->slots[index].key == 0) {
+        return NULL;
+    }
+    --self->size;
+
+    // shift back every later pair whose probe passed through the freed slot.
+    int64_t mask = self->capacity - 1;
+    for (int64_t next = (index + 1) & mask; self->slots[next].key != 0; next = (next + 1) & mask) {
+        int64_t home = crumb_mix64(self->slots[next].key) & mask;
+
+        if (((next - home) & mask) >= ((next - index) & mask)) {
+            self->slots[index] = self->slots[next];
+            index = next;
+        }
+    }
+    self->slots[index] = (u64map_slot_t) { .key = 0, .value = NULL };
+
+    return value;
+}
+
+int64_t u64map_size(u64map_t* self) {
+    return self->size;
+}
@@ -0,0 +1,95 @@
+#include "unity.h"
+
+#include "arena.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_arena_alloc_should_return_aligned_blocks(void) {
+    arena_t* arena = arena_new(1024);
+
+    for (int64_t n = 1; n < 100; ++n) {
+        void* block = arena_alloc(arena, n);
+
+        TEST_ASSERT_EQUAL(0, (uintptr_t) block % ARENA_ALIGNMENT);
+    }
+
+    arena_free(arena);
+}
+
+void test_arena_alloc_should_carve_blocks_from_chunks(void) {
+    arena_t* arena = arena_new(1024);
+
+    for (int64_t n = 0; n < 64; ++n) {
+        arena_alloc(arena, 16);
+    }
+
+    TEST_ASSERT_EQUAL(1, list_size(arena->chunks));
+
+    arena_alloc(arena, 16);
+
+    TEST_ASSERT_EQUAL(2, list_size(arena->chunks));
+
+    arena_free(arena);
+}
+
+void test_arena_release_should_reuse_block_of_same_class(void) {
+    arena_t* arena = arena_new(1024);
+    void* block = arena_alloc(arena, 40);
+
+    arena_release(arena, block, 40);
+
+    TEST_ASSERT_EQUAL_PTR(block, arena_alloc(arena, 33));
+    TEST_ASSERT_EQUAL(33, arena->bytes);
+
+    arena_free(arena);
+}
+
+void test_arena_release_should_free_large_blocks(void) {
+    arena_t* arena = arena_new(1024);
+    void* small = arena_alloc(arena, 16);
+    void* large1 = arena_alloc(arena, 4096);
+    void* large2 = arena_alloc(arena, 4096);
+
+    arena_release(arena, large1, 4096);
+
+    TEST_ASSERT_EQUAL(0, list_size(arena->chunks) - 1);
+    TEST_ASSERT_EQUAL(4096 + 16, arena->bytes);
+
+    arena_release(arena, large2, 4096);
+    arena_release(arena, small, 16);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, arena->large);
+    TEST_ASSERT_EQUAL(0, arena->bytes);
+
+    arena_free(arena);
+}
+
+void test_arena_clear_should_keep_one_chunk(void) {
+    arena_t* arena = arena_new(1024);
+
+    for (int64_t n = 0; n < 1000; ++n) {
+        arena_alloc(arena, 64);
+    }
+    arena_alloc(arena, 4096);
+
+    arena = arena_clear(arena);
+
+    TEST_ASSERT_EQUAL(1, list_size(arena->chunks));
+    TEST_ASSERT_EQUAL_PTR(list_get(arena->chunks, 0), arena_alloc(arena, 64));
+
+    arena_free(arena);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_arena_alloc_should_carve_blocks_from_chunks);
+    RUN_TEST(test_arena_alloc_should_return_aligned_blocks);
+    RUN_TEST(test_arena_clear_should_keep_one_chunk);
+    RUN_TEST(test_arena_release_should_free_large_blocks);
+    RUN_TEST(test_arena_release_should_reuse_block_of_same_class);
+
+    return UNITY_END();
+}
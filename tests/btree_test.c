@@ -0,0 +1,201 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "btree.h"
+#include "cstrings.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// btree_set_numbered_keys stores "key" followed by every n from start to
+// end in steps of step, zero padded so the keys sort in numeric order.
+void btree_set_numbered_keys(btree_t* tree, int64_t start, int64_t end, int64_t step) {
+    char text[32];
+
+    for (int64_t n = start; n < end; n += step) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%06" PRId64, n));
+        btree_set(tree, key, (void*) (n + 1));
+        string_free(key);
+    }
+}
+
+void test_btree_set_should_add_and_replace_pairs(void) {
+    btree_t* tree = btree_new();
+    string_t* key = string("hello", 5);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, btree_get(tree, key));
+
+    btree_set(tree, key, (void*) 1);
+    TEST_ASSERT_EQUAL_PTR((void*) 1, btree_get(tree, key));
+
+    btree_set(tree, key, (void*) 2);
+    TEST_ASSERT_EQUAL_PTR((void*) 2, btree_get(tree, key));
+    TEST_ASSERT_EQUAL(1, btree_size(tree));
+
+    btree_free(tree);
+    string_free(key);
+}
+
+void test_btree_iter_should_visit_keys_in_order(void) {
+    btree_t* tree = btree_new();
+
+    // insert in a scattered order so splits happen all over the tree.
+    for (int64_t n = 0; n < 20000; ++n) {
+        btree_set_numbered_keys(tree, (n * 7919) % 20000, (n * 7919) % 20000 + 1, 1);
+    }
+
+    TEST_ASSERT_EQUAL(20000, btree_size(tree));
+    TEST_ASSERT_FALSE(tree->root->leaf);
+
+    btree_iter_t iter = btree_iter(tree);
+    string_t* last = NULL;
+    int64_t count = 0;
+
+    while (btree_iter_next(&iter)) {
+        if (last != NULL) {
+            TEST_ASSERT_TRUE(string_compare(last, iter.key) < 0);
+        }
+        TEST_ASSERT_EQUAL_PTR((void*) (count + 1), iter.value);
+
+        last = iter.key;
+        ++count;
+    }
+
+    TEST_ASSERT_EQUAL(20000, count);
+
+    btree_free(tree);
+}
+
+void test_btree_delete_should_keep_other_pairs(void) {
+    btree_t* tree = btree_new();
+    char text[32];
+
+    btree_set_numbered_keys(tree, 0, 5000, 1);
+
+    for (int64_t n = 0; n < 5000; ++n) {
+        if (n % 3 == 0 || (n >= 1000 && n < 3000)) {
+            string_t* key = string(text, snprintf(text, sizeof(text), "key%06" PRId64, n));
+            TEST_ASSERT_EQUAL_PTR((void*) (n + 1), btree_delete(tree, key));
+            TEST_ASSERT_EQUAL_PTR(NULL, btree_delete(tree, key));
+            string_free(key);
+        }
+    }
+
+    int64_t expected = 0;
+    for (int64_t n = 0; n < 5000; ++n) {
+        bool deleted = n % 3 == 0 || (n >= 1000 && n < 3000);
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%06" PRId64, n));
+
+        TEST_ASSERT_EQUAL_PTR(deleted ? NULL : (void*) (n + 1), btree_get(tree, key));
+        expected += !deleted;
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(expected, btree_size(tree));
+
+    btree_iter_t iter = btree_iter(tree);
+    int64_t count = 0;
+
+    while (btree_iter_next(&iter)) {
+        ++count;
+    }
+
+    TEST_ASSERT_EQUAL(expected, count);
+
+    btree_free(tree);
+}
+
+void test_btree_delete_should_empty_tree(void) {
+    btree_t* tree = btree_new();
+    char text[32];
+
+    btree_set_numbered_keys(tree, 0, 3000, 1);
+
+    for (int64_t n = 0; n < 3000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%06" PRId64, n));
+        btree_delete(tree, key);
+        string_free(key);
+    }
+
+    btree_iter_t iter = btree_iter(tree);
+
+    TEST_ASSERT_EQUAL(0, btree_size(tree));
+    TEST_ASSERT_TRUE(tree->root->leaf);
+    TEST_ASSERT_FALSE(btree_iter_next(&iter));
+
+    btree_set_numbered_keys(tree, 0, 100, 1);
+
+    string_t* key = string("key000049", 9);
+    TEST_ASSERT_EQUAL_PTR((void*) 50, btree_get(tree, key));
+
+    btree_free(tree);
+    string_free(key);
+}
+
+void test_btree_lower_bound_should_start_at_key(void) {
+    btree_t* tree = btree_new();
+    string_t* bound = string("key000501", 9);
+
+    // only even numbers, so odd bounds fall between keys.
+    btree_set_numbered_keys(tree, 0, 2000, 2);
+
+    btree_iter_t iter = btree_lower_bound(tree, bound);
+
+    for (int64_t n = 502; n < 600; n += 2) {
+        TEST_ASSERT_TRUE(btree_iter_next(&iter));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), iter.value);
+    }
+
+    string_t* past = string("zzz", 3);
+    iter = btree_lower_bound(tree, past);
+
+    TEST_ASSERT_FALSE(btree_iter_next(&iter));
+
+    btree_free(tree);
+    string_free(bound);
+    string_free(past);
+}
+
+void test_btree_prefix_should_visit_matching_keys(void) {
+    btree_t* tree = btree_new();
+    char const* words[] = { "app", "apple", "application", "apply", "apricot", "banana", "ap" };
+
+    for (int n = 0; n < 7; ++n) {
+        string_t* key = string(words[n], strlen(words[n]));
+
+        btree_set(tree, key, (void*) (intptr_t) (n + 1));
+        string_free(key);
+    }
+
+    string_t* prefix = string("appl", 4);
+    btree_iter_t iter = btree_prefix(tree, prefix);
+    char const* expected[] = { "apple", "application", "apply" };
+
+    for (int n = 0; n < 3; ++n) {
+        TEST_ASSERT_TRUE(btree_iter_next(&iter));
+        TEST_ASSERT_EQUAL(strlen(expected[n]), iter.key->length);
+        TEST_ASSERT_EQUAL_MEMORY(expected[n], iter.key->buf, iter.key->length);
+    }
+
+    TEST_ASSERT_FALSE(btree_iter_next(&iter));
+
+    btree_free(tree);
+    string_free(prefix);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_btree_delete_should_empty_tree);
+    RUN_TEST(test_btree_delete_should_keep_other_pairs);
+    RUN_TEST(test_btree_iter_should_visit_keys_in_order);
+    RUN_TEST(test_btree_lower_bound_should_start_at_key);
+    RUN_TEST(test_btree_prefix_should_visit_matching_keys);
+    RUN_TEST(test_btree_set_should_add_and_replace_pairs);
+
+    return UNITY_END();
+}
@@ -0,0 +1,145 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#include "concurrent_map.h"
+#include "cstrings.h"
+
+#define THREAD_COUNT 8
+#define KEYS_PER_THREAD 2000
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+typedef struct worker_t {
+    concurrent_map_t* map;
+    int64_t id;
+    int64_t misses;
+} worker_t;
+
+void* worker_set_then_get(void* arg) {
+    worker_t* worker = arg;
+    char text[32];
+
+    for (int64_t n = 0; n < KEYS_PER_THREAD; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "%" PRId64 ":%" PRId64, worker->id, n));
+        concurrent_map_set(worker->map, key, (void*) (n + 1));
+        string_free(key);
+    }
+
+    for (int64_t n = 0; n < KEYS_PER_THREAD; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "%" PRId64 ":%" PRId64, worker->id, n));
+        if (concurrent_map_get(worker->map, key) != (void*) (n + 1)) {
+            ++worker->misses;
+        }
+        string_free(key);
+    }
+
+    return NULL;
+}
+
+void test_concurrent_map_new_should_round_shards_to_power_of_two(void) {
+    concurrent_map_t* map = concurrent_map_new(6, 8);
+
+    TEST_ASSERT_EQUAL(8, map->shard_count);
+    TEST_ASSERT_EQUAL(3, map->shard_bits);
+
+    concurrent_map_free(map);
+}
+
+void test_concurrent_map_set_should_set_key_to_value(void) {
+    concurrent_map_t* map = concurrent_map_new(4, 8);
+    string_t* key = string("hello", 5);
+    int value = 0;
+
+    map = concurrent_map_set(map, key, &value);
+
+    TEST_ASSERT_EQUAL_PTR(&value, concurrent_map_get(map, key));
+    TEST_ASSERT_EQUAL(1, concurrent_map_size(map));
+
+    concurrent_map_free(map);
+    string_free(key);
+}
+
+void test_concurrent_map_delete_should_return_element_if_key_found(void) {
+    concurrent_map_t* map = concurrent_map_new(4, 8);
+    string_t* key = string("hello", 5);
+    int value = 0;
+
+    map = concurrent_map_set(map, key, &value);
+
+    TEST_ASSERT_EQUAL_PTR(&value, concurrent_map_delete(map, key));
+    TEST_ASSERT_EQUAL_PTR(NULL, concurrent_map_delete(map, key));
+    TEST_ASSERT_EQUAL_PTR(NULL, concurrent_map_get(map, key));
+
+    concurrent_map_free(map);
+    string_free(key);
+}
+
+void test_concurrent_map_should_not_write_to_keys(void) {
+    concurrent_map_t* map = concurrent_map_new(4, 8);
+    string_t* key = string("hello", 5);
+    int value = 0;
+
+    concurrent_map_set(map, key, &value);
+    TEST_ASSERT_EQUAL_PTR(&value, concurrent_map_get(map, key));
+    TEST_ASSERT_EQUAL_PTR(&value, concurrent_map_delete(map, key));
+    TEST_ASSERT_EQUAL(0, key->hash);
+
+    concurrent_map_free(map);
+    string_free(key);
+}
+
+void test_concurrent_map_clear_should_remove_all_elements(void) {
+    concurrent_map_t* map = concurrent_map_new(4, 8);
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+    int value = 0;
+
+    map = concurrent_map_set(concurrent_map_set(map, key1, &value), key2, &value);
+    map = concurrent_map_clear(map);
+
+    TEST_ASSERT_EQUAL(0, concurrent_map_size(map));
+    TEST_ASSERT_EQUAL_PTR(NULL, concurrent_map_get(map, key1));
+
+    concurrent_map_free(map);
+    string_free(key1);
+    string_free(key2);
+}
+
+void test_concurrent_map_set_should_be_safe_across_threads(void) {
+    concurrent_map_t* map = concurrent_map_new(16, 8);
+    pthread_t threads[THREAD_COUNT];
+    worker_t workers[THREAD_COUNT];
+
+    for (int64_t n = 0; n < THREAD_COUNT; ++n) {
+        workers[n] = (worker_t) { .map = map, .id = n, .misses = 0 };
+        pthread_create(&threads[n], NULL, worker_set_then_get, &workers[n]);
+    }
+
+    for (int64_t n = 0; n < THREAD_COUNT; ++n) {
+        pthread_join(threads[n], NULL);
+        TEST_ASSERT_EQUAL(0, workers[n].misses);
+    }
+
+    TEST_ASSERT_EQUAL(THREAD_COUNT * KEYS_PER_THREAD, concurrent_map_size(map));
+
+    concurrent_map_free(map);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_concurrent_map_new_should_round_shards_to_power_of_two);
+
+    RUN_TEST(test_concurrent_map_clear_should_remove_all_elements);
+    RUN_TEST(test_concurrent_map_delete_should_return_element_if_key_found);
+    RUN_TEST(test_concurrent_map_set_should_set_key_to_value);
+    RUN_TEST(test_concurrent_map_set_should_be_safe_across_threads);
+    RUN_TEST(test_concurrent_map_should_not_write_to_keys);
+
+    return UNITY_END();
+}
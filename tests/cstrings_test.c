@@ -46,6 +46,16 @@ void test_string_equal_should_return_false_for_differing_data(void) {
     string_free(rhs);
 }
 
+void test_string_equal_should_compare_bytes_after_nul(void) {
+    string_t* lhs = string("a\0b", 3);
+    string_t* rhs = string("a\0c", 3);
+
+    TEST_ASSERT_FALSE(string_equal(lhs, rhs));
+
+    string_free(lhs);
+    string_free(rhs);
+}
+
 void test_string_data_should_return_original_char_array(void) {
     string_t* str = string("hello", 5);
 
@@ -130,6 +140,79 @@ void test_string_substr_should_return_substring_of_original_whole(void) {
     string_free(substr);
 }
 
+void test_string_hash_should_be_equal_for_same_data(void) {
+    string_t* lhs = string("hello", 5);
+    string_t* rhs = string("hello", 5);
+
+    TEST_ASSERT_TRUE(string_hash(lhs) == string_hash(rhs));
+
+    string_free(lhs);
+    string_free(rhs);
+}
+
+void test_string_hash_uncached_should_not_cache_hash(void) {
+    string_t* str = string("hello", 5);
+    uint64_t hash = string_hash_uncached(str);
+
+    TEST_ASSERT_EQUAL(0, str->hash);
+    TEST_ASSERT_EQUAL_UINT64(hash, string_hash(str));
+    TEST_ASSERT_EQUAL_UINT64(hash, string_hash_uncached(str));
+
+    string_free(str);
+}
+
+void test_string_hash_should_be_cached_after_first_call(void) {
+    string_t* str = string("hello", 5);
+
+    TEST_ASSERT_TRUE(str->hash == 0);
+
+    uint64_t hash = string_hash(str);
+
+    TEST_ASSERT_TRUE(str->hash == hash);
+
+    string_free(str);
+}
+
+void test_string_copy_should_keep_cached_hash(void) {
+    string_t* original = string("hello", 5);
+    uint64_t hash = string_hash(original);
+    string_t* copy = string_copy(original);
+
+    TEST_ASSERT_TRUE(copy->hash == hash);
+
+    string_free(original);
+    string_free(copy);
+}
+
+void test_string_view_should_reference_original_data(void) {
+    char const* text = "hello world";
+    string_t view = string_view(text + 6, 5);
+    string_t* copy = string("world", 5);
+
+    TEST_ASSERT_EQUAL_PTR(text + 6, string_data(&view));
+    TEST_ASSERT_EQUAL(5, string_length(&view));
+    TEST_ASSERT_TRUE(string_equal(&view, copy));
+    TEST_ASSERT_EQUAL(string_hash(copy), string_hash(&view));
+
+    string_free(copy);
+}
+
+void test_string_compare_should_order_lexicographically(void) {
+    string_t* a = string("abc", 3);
+    string_t* b = string("abd", 3);
+    string_t* prefix = string("ab", 2);
+
+    TEST_ASSERT_TRUE(string_compare(a, b) < 0);
+    TEST_ASSERT_TRUE(string_compare(b, a) > 0);
+    TEST_ASSERT_TRUE(string_compare(prefix, a) < 0);
+    TEST_ASSERT_TRUE(string_compare(a, prefix) > 0);
+    TEST_ASSERT_EQUAL(0, string_compare(a, a));
+
+    string_free(a);
+    string_free(b);
+    string_free(prefix);
+}
+
 int main(void) {
     UNITY_BEGIN();
 
@@ -137,6 +220,7 @@ int main(void) {
     RUN_TEST(test_string_equal_should_return_true_for_same_data);
     RUN_TEST(test_string_equal_should_return_true_for_same_identity);
     RUN_TEST(test_string_equal_should_return_false_for_differing_data);
+    RUN_TEST(test_string_equal_should_compare_bytes_after_nul);
     RUN_TEST(test_string_data_should_return_original_char_array);
     RUN_TEST(test_string_length_should_return_original_length);
     RUN_TEST(test_string_substr_should_return_null_if_start_after_end);
@@ -146,5 +230,12 @@ int main(void) {
     RUN_TEST(test_string_substr_should_return_substring_of_original_start);
     RUN_TEST(test_string_substr_should_return_substring_of_original_whole);
 
+    RUN_TEST(test_string_compare_should_order_lexicographically);
+    RUN_TEST(test_string_copy_should_keep_cached_hash);
+    RUN_TEST(test_string_hash_should_be_cached_after_first_call);
+    RUN_TEST(test_string_hash_should_be_equal_for_same_data);
+    RUN_TEST(test_string_hash_uncached_should_not_cache_hash);
+    RUN_TEST(test_string_view_should_reference_original_data);
+
     UNITY_END();
 }
@@ -0,0 +1,139 @@
+#include "unity.h"
+
+#include "deque.h"
+#include "list.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_deque_push_back_should_pop_in_fifo_order(void) {
+    deque_t* deque = deque_new(4);
+
+    for (intptr_t n = 1; n <= 100000; ++n) {
+        deque_push_back(deque, (void*) n);
+    }
+
+    TEST_ASSERT_EQUAL(100000, deque_size(deque));
+
+    for (intptr_t n = 1; n <= 100000; ++n) {
+        TEST_ASSERT_EQUAL_PTR((void*) n, deque_pop_front(deque));
+    }
+
+    TEST_ASSERT_EQUAL(0, deque_size(deque));
+    TEST_ASSERT_EQUAL_PTR(NULL, deque_pop_front(deque));
+    TEST_ASSERT_EQUAL_PTR(NULL, deque_pop_back(deque));
+
+    deque_free(deque);
+}
+
+void test_deque_push_front_should_pop_in_lifo_order(void) {
+    deque_t* deque = deque_new(0);
+
+    for (intptr_t n = 1; n <= 100; ++n) {
+        deque_push_front(deque, (void*) n);
+    }
+
+    for (intptr_t n = 100; n >= 1; --n) {
+        TEST_ASSERT_EQUAL_PTR((void*) n, deque_pop_front(deque));
+    }
+
+    deque_free(deque);
+}
+
+void test_deque_should_wrap_without_growing(void) {
+    deque_t* deque = deque_new(8);
+
+    // keep 5 elements in flight so the head wraps around many times.
+    for (intptr_t n = 1; n <= 5; ++n) {
+        deque_push_back(deque, (void*) n);
+    }
+
+    for (intptr_t n = 6; n <= 1000; ++n) {
+        TEST_ASSERT_EQUAL_PTR((void*) (n - 5), deque_pop_front(deque));
+        deque_push_back(deque, (void*) n);
+    }
+
+    TEST_ASSERT_EQUAL(8, deque_capacity(deque));
+    TEST_ASSERT_EQUAL_PTR((void*) 996, deque_get(deque, 0));
+    TEST_ASSERT_EQUAL_PTR((void*) 1000, deque_get(deque, 4));
+    TEST_ASSERT_EQUAL_PTR(NULL, deque_get(deque, 5));
+
+    deque_free(deque);
+}
+
+void test_deque_should_grow_while_wrapped(void) {
+    deque_t* deque = deque_new(8);
+
+    // fill the buffer with its head in the middle, then grow it.
+    for (intptr_t n = 5; n <= 8; ++n) {
+        deque_push_back(deque, (void*) n);
+    }
+    for (intptr_t n = 4; n >= 1; --n) {
+        deque_push_front(deque, (void*) n);
+    }
+    deque_push_back(deque, (void*) 9);
+
+    TEST_ASSERT_EQUAL(16, deque_capacity(deque));
+
+    for (intptr_t n = 1; n <= 9; ++n) {
+        TEST_ASSERT_EQUAL_PTR((void*) n, deque_get(deque, n - 1));
+    }
+
+    TEST_ASSERT_EQUAL_PTR((void*) 9, deque_pop_back(deque));
+    TEST_ASSERT_EQUAL_PTR((void*) 8, deque_pop_back(deque));
+
+    deque_free(deque);
+}
+
+void test_deque_set_should_replace_element(void) {
+    deque_t* deque = deque_new(8);
+
+    deque_push_back(deque_push_front(deque, (void*) 1), (void*) 2);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 3, deque_set(deque, 1, (void*) 3));
+    TEST_ASSERT_EQUAL_PTR(NULL, deque_set(deque, 2, (void*) 4));
+    TEST_ASSERT_EQUAL_PTR(NULL, deque_set(deque, -1, (void*) 4));
+    TEST_ASSERT_EQUAL_PTR((void*) 1, deque_get(deque, 0));
+    TEST_ASSERT_EQUAL_PTR((void*) 3, deque_get(deque, 1));
+
+    deque_clear(deque);
+    TEST_ASSERT_EQUAL(0, deque_size(deque));
+    TEST_ASSERT_EQUAL_PTR(NULL, deque_get(deque, 0));
+
+    deque_free(deque);
+}
+
+void test_deque_to_list_should_copy_elements_in_order(void) {
+    deque_t* deque = deque_new(8);
+
+    for (intptr_t n = 4; n <= 8; ++n) {
+        deque_push_back(deque, (void*) n);
+    }
+    for (intptr_t n = 3; n >= 1; --n) {
+        deque_push_front(deque, (void*) n);
+    }
+
+    list_t* list = deque_to_list(deque);
+
+    TEST_ASSERT_EQUAL(8, list_size(list));
+    for (intptr_t n = 1; n <= 8; ++n) {
+        TEST_ASSERT_EQUAL_PTR((void*) n, list_get(list, n - 1));
+    }
+
+    list_free(list);
+    deque_free(deque);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_deque_push_back_should_pop_in_fifo_order);
+    RUN_TEST(test_deque_push_front_should_pop_in_lifo_order);
+    RUN_TEST(test_deque_set_should_replace_element);
+    RUN_TEST(test_deque_should_grow_while_wrapped);
+    RUN_TEST(test_deque_should_wrap_without_growing);
+    RUN_TEST(test_deque_to_list_should_copy_elements_in_order);
+
+    return UNITY_END();
+}
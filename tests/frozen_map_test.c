@@ -0,0 +1,127 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "cstrings.h"
+#include "frozen_map.h"
+#include "map.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+map_t* map_set_numbered_keys(map_t* map, int64_t count) {
+    char text[32];
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        map = map_set(map, key, (void*) (n + 1));
+        string_free(key);
+    }
+
+    return map;
+}
+
+void test_map_freeze_should_return_empty_map_if_empty(void) {
+    map_t* map = map_new(4, 4);
+    frozen_map_t* frozen = map_freeze(map);
+    string_t* key = string("hello", 5);
+
+    TEST_ASSERT_EQUAL(0, frozen_map_size(frozen));
+    TEST_ASSERT_EQUAL_PTR(NULL, frozen_map_get(frozen, key));
+
+    frozen_map_free(frozen);
+    map_free(map);
+    string_free(key);
+}
+
+void test_map_freeze_should_keep_every_pair(void) {
+    map_t* maps[] = { map_set_numbered_keys(map_new(64, 4), 10000), map_set_numbered_keys(map_new_flat(64), 10000) };
+    char text[32];
+
+    for (int64_t m = 0; m < 2; ++m) {
+        frozen_map_t* frozen = map_freeze(maps[m]);
+
+        TEST_ASSERT_EQUAL(10000, frozen_map_size(frozen));
+
+        for (int64_t n = 0; n < 10000; ++n) {
+            string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+            TEST_ASSERT_EQUAL_PTR((void*) (n + 1), frozen_map_get(frozen, key));
+            string_free(key);
+        }
+
+        frozen_map_free(frozen);
+        map_free(maps[m]);
+    }
+}
+
+void test_map_freeze_should_return_null_if_key_not_found(void) {
+    map_t* map = map_set_numbered_keys(map_new(64, 4), 1000);
+    frozen_map_t* frozen = map_freeze(map);
+    char text[32];
+
+    for (int64_t n = 1000; n < 2000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR(NULL, frozen_map_get(frozen, key));
+        string_free(key);
+    }
+
+    frozen_map_free(frozen);
+    map_free(map);
+}
+
+void test_map_freeze_should_pack_keys_in_slot_order(void) {
+    map_t* map = map_new(4, 4);
+    string_t* key1 = string("a", 1);
+    string_t* key2 = string("bb", 2);
+    string_t* key3 = string("ccc", 3);
+
+    map = map_set(map, key1, (void*) 1);
+    map = map_set(map, key2, (void*) 2);
+    map = map_set(map, key3, (void*) 3);
+
+    frozen_map_t* frozen = map_freeze(map);
+
+    TEST_ASSERT_EQUAL(0, frozen->slots[0].offset);
+    TEST_ASSERT_EQUAL(6, frozen->slots[3].offset);
+    TEST_ASSERT_EQUAL_PTR((void*) 2, frozen_map_get(frozen, key2));
+
+    frozen_map_free(frozen);
+    map_free(map);
+    string_free(key1);
+    string_free(key2);
+    string_free(key3);
+}
+
+void test_map_freeze_should_not_share_lifetime_with_map(void) {
+    map_t* map = map_new(4, 4);
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+
+    map = map_set(map, key1, (void*) 1);
+    map = map_set(map, key2, (void*) 2);
+
+    frozen_map_t* frozen = map_freeze(map);
+
+    map_free(map);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 1, frozen_map_get(frozen, key1));
+    TEST_ASSERT_EQUAL_PTR((void*) 2, frozen_map_get(frozen, key2));
+
+    frozen_map_free(frozen);
+    string_free(key1);
+    string_free(key2);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_map_freeze_should_keep_every_pair);
+    RUN_TEST(test_map_freeze_should_not_share_lifetime_with_map);
+    RUN_TEST(test_map_freeze_should_pack_keys_in_slot_order);
+    RUN_TEST(test_map_freeze_should_return_empty_map_if_empty);
+    RUN_TEST(test_map_freeze_should_return_null_if_key_not_found);
+
+    return UNITY_END();
+}
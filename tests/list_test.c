@@ -2,7 +2,10 @@
 
 #include "unity.h"
 
+#include <stdatomic.h>
+
 #include "cstrings.h"
+#include "math.h"
 
 void setUp(void) {}
 
@@ -451,6 +454,262 @@ void test_list_resize_should_increase_list_capacity(void) {
     list_free(list);
 }
 
+void test_list_find_should_return_first_match_at_every_position(void) {
+    // sizes around the vector widths exercise every tail length.
+    for (int64_t size = 0; size < 80; ++size) {
+        list_t* list = list_new(8);
+
+        for (intptr_t n = 0; n < size; ++n) {
+            list = list_append(list, (void*) (n + 1));
+        }
+
+        for (intptr_t n = 0; n < size; ++n) {
+            TEST_ASSERT_EQUAL(n, list_find(list, (void*) (n + 1)));
+        }
+        TEST_ASSERT_EQUAL(-1, list_find(list, (void*) 0));
+
+        // only the high half of this value matches the first element.
+        TEST_ASSERT_EQUAL(-1, list_find(list, (void*) (((intptr_t) 1 << 32) + 1)));
+
+        list_free(list);
+    }
+}
+
+void test_list_find_all_should_return_every_match(void) {
+    list_t* list = list_new(8);
+    string_t* hit = string("hit", 3);
+    string_t* miss = string("miss", 4);
+
+    for (int64_t n = 0; n < 1000; ++n) {
+        list = list_append(list, n % 7 == 0 || n == 999 ? hit : miss);
+    }
+
+    i64list_t* indices = list_find_all(list, hit);
+    i64list_t* none = list_find_all(list, NULL);
+
+    TEST_ASSERT_EQUAL(144, i64list_size(indices));
+    for (int64_t n = 0; n < 143; ++n) {
+        TEST_ASSERT_EQUAL(n * 7, *i64list_get(indices, n));
+    }
+    TEST_ASSERT_EQUAL(999, *i64list_get(indices, 143));
+    TEST_ASSERT_EQUAL(0, i64list_size(none));
+
+    i64list_free(indices);
+    i64list_free(none);
+    list_free(list);
+    string_free(hit);
+    string_free(miss);
+}
+
+int list_compare_int_fn(void* lhs, void* rhs, void* ctx) {
+    // parallel sorts pass no counter, since the threads would race on it.
+    if (ctx != NULL) {
+        ++*(int64_t*) ctx;
+    }
+
+    return ((intptr_t) lhs > (intptr_t) rhs) - ((intptr_t) lhs < (intptr_t) rhs);
+}
+
+int list_compare_string_fn(void* lhs, void* rhs, void* ctx) {
+    return string_compare(lhs, rhs);
+}
+
+uint64_t list_test_random(uint64_t* state) {
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+    return *state >> 33;
+}
+
+// list_test_pattern fills a list with one of several adversarial patterns.
+list_t* list_test_pattern(int pattern, int64_t size, uint64_t* state) {
+    list_t* list = list_new(crumb_max(size, 1));
+
+    for (int64_t n = 0; n < size; ++n) {
+        intptr_t value;
+
+        switch (pattern) {
+            case 0: value = list_test_random(state) % 1000000; break;
+            case 1: value = n; break;
+            case 2: value = size - n; break;
+            case 3: value = list_test_random(state) % 4; break;
+            case 4: value = n % 100; break;
+            default: value = n == size / 2 ? 0 : n; break;
+        }
+
+        list = list_append(list, (void*) value);
+    }
+
+    return list;
+}
+
+void list_test_assert_sorted(list_t* list, int64_t sum) {
+    for (int64_t n = 1; n < list_size(list); ++n) {
+        TEST_ASSERT_TRUE((intptr_t) list_get(list, n - 1) <= (intptr_t) list_get(list, n));
+    }
+    for (int64_t n = 0; n < list_size(list); ++n) {
+        sum -= (intptr_t) list_get(list, n);
+    }
+
+    TEST_ASSERT_EQUAL(0, sum);
+}
+
+int64_t list_test_sum(list_t* list) {
+    int64_t sum = 0;
+
+    for (int64_t n = 0; n < list_size(list); ++n) {
+        sum += (intptr_t) list_get(list, n);
+    }
+
+    return sum;
+}
+
+void test_list_sort_should_sort_every_pattern(void) {
+    int64_t sizes[] = { 0, 1, 2, 23, 24, 129, 1000, 20000 };
+    uint64_t state = 42;
+
+    for (int pattern = 0; pattern < 6; ++pattern) {
+        for (int s = 0; s < 8; ++s) {
+            list_t* list = list_test_pattern(pattern, sizes[s], &state);
+            int64_t sum = list_test_sum(list);
+            int64_t compares = 0;
+
+            list = list_sort(list, list_compare_int_fn, &compares);
+
+            list_test_assert_sorted(list, sum);
+            list_free(list);
+        }
+    }
+}
+
+void test_list_sort_should_take_linear_time_if_sorted(void) {
+    uint64_t state = 42;
+    list_t* list = list_test_pattern(1, 100000, &state);
+    int64_t compares = 0;
+
+    list_sort(list, list_compare_int_fn, &compares);
+
+    TEST_ASSERT_TRUE(compares < 4 * 100000);
+
+    list_free(list);
+}
+
+void test_list_sort_parallel_should_merge_sorted_runs(void) {
+    uint64_t state = 7;
+
+    // 3 threads leave an odd run to carry over, 8 exceed the number of runs.
+    // duplicates and presorted runs put many co-ranks on ties and range ends.
+    for (int pattern = 0; pattern < 6; ++pattern) {
+        for (int64_t threads = 1; threads <= 8; threads += 2) {
+            list_t* list = list_test_pattern(pattern, 300000, &state);
+            int64_t sum = list_test_sum(list);
+
+            list = list_sort_parallel(list, list_compare_int_fn, NULL, threads);
+
+            list_test_assert_sorted(list, sum);
+            list_free(list);
+        }
+    }
+}
+
+void test_list_sort_strings_should_match_string_compare(void) {
+    char const* alphabet = "ab\xff";
+    uint64_t state = 3;
+    list_t* radix = list_new(8);
+    list_t* sorted = list_new(8);
+
+    // short keys over a tiny alphabet give many shared prefixes and duplicates.
+    for (int64_t n = 0; n < 5000; ++n) {
+        char text[8];
+        int64_t length = list_test_random(&state) % 7;
+
+        for (int64_t c = 0; c < length; ++c) {
+            text[c] = alphabet[list_test_random(&state) % 3];
+        }
+
+        string_t* key = string(text, length);
+        radix = list_append(radix, key);
+        sorted = list_append(sorted, key);
+    }
+
+    list_sort_strings(radix);
+    list_sort(sorted, list_compare_string_fn, NULL);
+
+    for (int64_t n = 0; n < 5000; ++n) {
+        TEST_ASSERT_EQUAL(0, string_compare(list_get(radix, n), list_get(sorted, n)));
+    }
+    TEST_ASSERT_EQUAL(0, string_length(list_get(radix, 0)));
+
+    list_foreach(radix, list_foreach_string_free_callback);
+    list_free(radix);
+    list_free(sorted);
+}
+
+void test_list_bsearch_should_find_sorted_elements(void) {
+    list_t* list = list_new(8);
+    int64_t compares = 0;
+
+    for (intptr_t n = 0; n < 100; ++n) {
+        list = list_append(list, (void*) (n / 2 * 2));
+    }
+
+    TEST_ASSERT_EQUAL(20, list_bsearch(list, (void*) 20, list_compare_int_fn, &compares));
+    TEST_ASSERT_EQUAL(-1, list_bsearch(list, (void*) 21, list_compare_int_fn, &compares));
+    TEST_ASSERT_EQUAL(22, list_lower_bound(list, (void*) 21, list_compare_int_fn, &compares));
+    TEST_ASSERT_EQUAL(0, list_lower_bound(list, (void*) -1, list_compare_int_fn, &compares));
+    TEST_ASSERT_EQUAL(100, list_lower_bound(list, (void*) 99, list_compare_int_fn, &compares));
+    TEST_ASSERT_TRUE(compares <= 5 * 8);
+
+    list_free(list);
+}
+
+void list_add_fn(void* elem, void* ctx) {
+    atomic_fetch_add((_Atomic int64_t*) ctx, (intptr_t) elem);
+}
+
+void* list_square_fn(void* elem, void* ctx) {
+    return (void*) ((intptr_t) elem * (intptr_t) elem);
+}
+
+void* list_sum_fn(void* lhs, void* rhs, void* ctx) {
+    return (void*) ((intptr_t) lhs + (intptr_t) rhs);
+}
+
+void* list_first_fn(void* lhs, void* rhs, void* ctx) {
+    return lhs;
+}
+
+void test_list_foreach_parallel_should_visit_every_element(void) {
+    list_t* list = list_new(8);
+    _Atomic int64_t sum = 0;
+
+    for (intptr_t n = 1; n <= 100000; ++n) {
+        list = list_append(list, (void*) n);
+    }
+
+    list_foreach_parallel(list, list_add_fn, &sum, 0);
+    TEST_ASSERT_EQUAL(100000LL * 100001 / 2, sum);
+
+    list_foreach_parallel(list, list_add_fn, &sum, 7);
+    TEST_ASSERT_EQUAL(100000LL * 100001, sum);
+
+    list_free(list);
+}
+
+void test_list_reduce_parallel_should_combine_in_order(void) {
+    list_t* list = list_new(8);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, list_reduce_parallel(list, list_square_fn, list_sum_fn, NULL));
+
+    for (intptr_t n = 1; n <= 10000; ++n) {
+        list = list_append(list, (void*) n);
+    }
+
+    TEST_ASSERT_EQUAL(10000LL * 10001 * 20001 / 6, (intptr_t) list_reduce_parallel(list, list_square_fn, list_sum_fn, NULL));
+    TEST_ASSERT_EQUAL_PTR((void*) 1, list_reduce_parallel(list, list_square_fn, list_first_fn, NULL));
+
+    list_free(list);
+}
+
 int main(void) {
     UNITY_BEGIN();
 
@@ -481,10 +740,20 @@ int main(void) {
     RUN_TEST(test_list_equal_should_return_true_if_same_identity);
 
     RUN_TEST(test_list_capacity_should_reflect_internal_capacity);
+    RUN_TEST(test_list_bsearch_should_find_sorted_elements);
+    RUN_TEST(test_list_find_all_should_return_every_match);
+    RUN_TEST(test_list_find_should_return_first_match_at_every_position);
     RUN_TEST(test_list_find_should_return_index_of_found_element);
+    RUN_TEST(test_list_foreach_parallel_should_visit_every_element);
+    RUN_TEST(test_list_reduce_parallel_should_combine_in_order);
     RUN_TEST(test_list_find_should_return_negative_int_if_element_missing);
     RUN_TEST(test_list_size_should_reflect_elements);
 
+    RUN_TEST(test_list_sort_parallel_should_merge_sorted_runs);
+    RUN_TEST(test_list_sort_should_sort_every_pattern);
+    RUN_TEST(test_list_sort_should_take_linear_time_if_sorted);
+    RUN_TEST(test_list_sort_strings_should_match_string_compare);
+
     RUN_TEST(test_list_get_should_return_element_at_index);
     RUN_TEST(test_list_get_should_return_null_if_out_of_bounds);
     RUN_TEST(test_list_pop_should_return_element_at_index);
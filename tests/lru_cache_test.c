@@ -0,0 +1,194 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "cstrings.h"
+#include "lru_cache.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void lru_cache_sum_fn(string_t* key, void* value, void* ctx) {
+    *(int64_t*) ctx += (intptr_t) value;
+}
+
+void test_lru_cache_put_should_evict_least_recently_used(void) {
+    lru_cache_t* cache = lru_cache_new(3, LRU_POLICY_LRU, NULL, NULL);
+    string_t* keys[] = { string("a", 1), string("b", 1), string("c", 1), string("d", 1) };
+
+    lru_cache_put(cache, keys[0], (void*) 1, 1);
+    lru_cache_put(cache, keys[1], (void*) 2, 1);
+    lru_cache_put(cache, keys[2], (void*) 3, 1);
+
+    // touching a makes b the least recently used entry.
+    TEST_ASSERT_EQUAL_PTR((void*) 1, lru_cache_get(cache, keys[0]));
+
+    lru_cache_put(cache, keys[3], (void*) 4, 1);
+
+    TEST_ASSERT_EQUAL(3, lru_cache_size(cache));
+    TEST_ASSERT_EQUAL_PTR((void*) 1, lru_cache_get(cache, keys[0]));
+    TEST_ASSERT_EQUAL_PTR(NULL, lru_cache_get(cache, keys[1]));
+    TEST_ASSERT_EQUAL_PTR((void*) 3, lru_cache_get(cache, keys[2]));
+    TEST_ASSERT_EQUAL_PTR((void*) 4, lru_cache_get(cache, keys[3]));
+
+    lru_cache_free(cache);
+    for (int n = 0; n < 4; ++n) {
+        string_free(keys[n]);
+    }
+}
+
+void test_lru_cache_put_should_respect_cost_budget(void) {
+    int64_t evicted = 0;
+    lru_cache_t* cache = lru_cache_new(100, LRU_POLICY_LRU, lru_cache_sum_fn, &evicted);
+    string_t* small = string("small", 5);
+    string_t* large = string("large", 5);
+    string_t* huge = string("huge", 4);
+
+    lru_cache_put(cache, small, (void*) 1, 40);
+    lru_cache_put(cache, large, (void*) 2, 50);
+    TEST_ASSERT_EQUAL(90, lru_cache_stats(cache).cost);
+
+    // replacing a value passes the old one to the eviction function.
+    lru_cache_put(cache, large, (void*) 4, 70);
+    TEST_ASSERT_EQUAL(2 + 1, evicted);
+    TEST_ASSERT_EQUAL_PTR(NULL, lru_cache_get(cache, small));
+    TEST_ASSERT_EQUAL(70, lru_cache_stats(cache).cost);
+
+    lru_cache_put(cache, huge, (void*) 8, 200);
+    TEST_ASSERT_EQUAL(2 + 1 + 4 + 8, evicted);
+    TEST_ASSERT_EQUAL(0, lru_cache_size(cache));
+    TEST_ASSERT_EQUAL(0, lru_cache_stats(cache).cost);
+
+    lru_cache_free(cache);
+    string_free(small);
+    string_free(large);
+    string_free(huge);
+}
+
+void test_lru_cache_put_should_not_evict_same_value(void) {
+    int64_t evicted = 0;
+    lru_cache_t* cache = lru_cache_new(10, LRU_POLICY_LRU, lru_cache_sum_fn, &evicted);
+    string_t* key = string("hello", 5);
+
+    lru_cache_put(cache, key, (void*) 1, 1);
+    lru_cache_put(cache, key, (void*) 1, 2);
+
+    TEST_ASSERT_EQUAL(0, evicted);
+    TEST_ASSERT_EQUAL_PTR((void*) 1, lru_cache_get(cache, key));
+    TEST_ASSERT_EQUAL(2, lru_cache_stats(cache).cost);
+
+    lru_cache_put(cache, key, (void*) 2, 1);
+
+    TEST_ASSERT_EQUAL(1, evicted);
+
+    lru_cache_free(cache);
+    string_free(key);
+}
+
+void test_lru_cache_stats_should_count_hits_and_misses(void) {
+    lru_cache_t* cache = lru_cache_new(10, LRU_POLICY_LRU, NULL, NULL);
+    char text[32];
+
+    for (int64_t n = 0; n < 15; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        lru_cache_put(cache, key, (void*) (n + 1), 1);
+        string_free(key);
+    }
+
+    for (int64_t n = 0; n < 15; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        lru_cache_get(cache, key);
+        string_free(key);
+    }
+
+    lru_cache_stats_t stats = lru_cache_stats(cache);
+
+    TEST_ASSERT_EQUAL(10, stats.hits);
+    TEST_ASSERT_EQUAL(5, stats.misses);
+    TEST_ASSERT_EQUAL(5, stats.evictions);
+    TEST_ASSERT_EQUAL(10, stats.size);
+
+    lru_cache_free(cache);
+}
+
+void test_lru_cache_delete_should_skip_eviction_function(void) {
+    int64_t evicted = 0;
+    lru_cache_t* cache = lru_cache_new(10, LRU_POLICY_LRU, lru_cache_sum_fn, &evicted);
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+
+    lru_cache_put(cache, key1, (void*) 1, 1);
+    lru_cache_put(cache, key2, (void*) 2, 1);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 2, lru_cache_delete(cache, key2));
+    TEST_ASSERT_EQUAL_PTR(NULL, lru_cache_delete(cache, key2));
+    TEST_ASSERT_EQUAL(1, lru_cache_size(cache));
+    TEST_ASSERT_EQUAL(0, evicted);
+
+    lru_cache_free(cache);
+    string_free(key1);
+    string_free(key2);
+}
+
+void test_lru_cache_clock_should_give_referenced_entries_second_chance(void) {
+    lru_cache_t* cache = lru_cache_new(3, LRU_POLICY_CLOCK, NULL, NULL);
+    string_t* keys[] = { string("a", 1), string("b", 1), string("c", 1), string("d", 1) };
+
+    lru_cache_put(cache, keys[0], (void*) 1, 1);
+    lru_cache_put(cache, keys[1], (void*) 2, 1);
+    lru_cache_put(cache, keys[2], (void*) 3, 1);
+
+    // a hit only marks a, leaving the recency list untouched.
+    lru_cache_get(cache, keys[0]);
+    TEST_ASSERT_EQUAL_STRING_LEN("a", cache->tail->key.buf, 1);
+    TEST_ASSERT_TRUE(cache->tail->referenced);
+
+    lru_cache_put(cache, keys[3], (void*) 4, 1);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 1, lru_cache_get(cache, keys[0]));
+    TEST_ASSERT_EQUAL_PTR(NULL, lru_cache_get(cache, keys[1]));
+    TEST_ASSERT_EQUAL_PTR((void*) 3, lru_cache_get(cache, keys[2]));
+    TEST_ASSERT_EQUAL_PTR((void*) 4, lru_cache_get(cache, keys[3]));
+
+    lru_cache_free(cache);
+    for (int n = 0; n < 4; ++n) {
+        string_free(keys[n]);
+    }
+}
+
+void test_lru_cache_should_keep_many_entries(void) {
+    lru_cache_t* cache = lru_cache_new(1000, LRU_POLICY_LRU, NULL, NULL);
+    char text[32];
+
+    for (int64_t n = 0; n < 5000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        lru_cache_put(cache, key, (void*) (n + 1), 1);
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(1000, lru_cache_size(cache));
+
+    for (int64_t n = 0; n < 5000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR(n >= 4000 ? (void*) (n + 1) : NULL, lru_cache_get(cache, key));
+        string_free(key);
+    }
+
+    lru_cache_free(cache);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_lru_cache_clock_should_give_referenced_entries_second_chance);
+    RUN_TEST(test_lru_cache_delete_should_skip_eviction_function);
+    RUN_TEST(test_lru_cache_put_should_evict_least_recently_used);
+    RUN_TEST(test_lru_cache_put_should_not_evict_same_value);
+    RUN_TEST(test_lru_cache_put_should_respect_cost_budget);
+    RUN_TEST(test_lru_cache_should_keep_many_entries);
+    RUN_TEST(test_lru_cache_stats_should_count_hits_and_misses);
+
+    return UNITY_END();
+}
@@ -1,5 +1,9 @@
 #include "unity.h"
 
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
 #include "map.h"
 #include "cstrings.h"
 #include "tuple.h"
@@ -8,6 +12,18 @@ void setUp(void) {}
 
 void tearDown(void) {}
 
+map_t* map_set_numbered_keys(map_t* map, int64_t count) {
+    char text[32];
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        map = map_set(map, key, (void*) (n + 1));
+        string_free(key);
+    }
+
+    return map;
+}
+
 void test_map_copy_should_return_a_new_copy(void) {
     map_t* original = map_new(2, 8);
     map_t* copy = map_copy(original, 2, 8);
@@ -272,16 +288,677 @@ void test_map_get_should_return_null_if_key_not_found(void) {
     string_free(key);
 }
 
+void test_map_set_should_grow_bucket_count(void) {
+    map_t* map = map_set_numbered_keys(map_new(2, 1), 1000);
+    char text[32];
+
+    TEST_ASSERT_EQUAL(1000, map->size);
+    TEST_ASSERT_TRUE(list_size(map->buckets) >= 512);
+
+    for (int64_t n = 0; n < 1000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), map_get(map, key));
+        string_free(key);
+    }
+
+    map_free(map);
+}
+
+void test_map_set_should_migrate_buckets_incrementally(void) {
+    map_t* map = map_set_numbered_keys(map_new(64, 1), 65);
+    char text[32];
+
+    TEST_ASSERT_EQUAL(128, list_size(map->buckets));
+    TEST_ASSERT_NOT_EQUAL(NULL, map->old_buckets);
+
+    // lookups find pairs in either bucket list without migrating any.
+    list_t* old_buckets = map->old_buckets;
+    int64_t migrate_index = map->migrate_index;
+
+    for (int64_t n = 0; n < 65; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), map_get(map, key));
+        TEST_ASSERT_TRUE(map_contains_bytes(map, string_data(key), string_length(key)));
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL_PTR(old_buckets, map->old_buckets);
+    TEST_ASSERT_EQUAL(migrate_index, map->migrate_index);
+
+    for (int64_t n = 0; n < 65; n += 2) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), map_delete(map, key));
+        string_free(key);
+    }
+
+    for (int64_t n = 0; n < 65; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR(n % 2 ? (void*) (n + 1) : NULL, map_get(map, key));
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(32, map->size);
+    TEST_ASSERT_EQUAL_PTR(NULL, map->old_buckets);
+
+    map_free(map);
+}
+
+void test_map_get_hashed_should_return_value_set_hashed(void) {
+    map_t* chained = map_new(2, 8);
+    map_t* flat = map_new_flat(4);
+    string_t* key = string("hello", 5);
+    string_t* other = string("hello", 5);
+    uint64_t hash = string_hash(key);
+    tuple_t* value = tuple_new(0, 0);
+
+    chained = map_set_hashed(chained, key, hash, value);
+    flat = map_set_hashed(flat, key, hash, value);
+
+    TEST_ASSERT_EQUAL_PTR(value, map_get_hashed(chained, key, hash));
+    TEST_ASSERT_EQUAL_PTR(value, map_get_hashed(flat, key, hash));
+    TEST_ASSERT_EQUAL_PTR(value, map_get(chained, other));
+    TEST_ASSERT_EQUAL_PTR(value, map_get(flat, other));
+
+    map_free(chained);
+    map_free(flat);
+    string_free(key);
+    string_free(other);
+    tuple_free(value);
+}
+
+void test_map_get_many_should_return_value_for_each_key(void) {
+    map_t* chained = map_new(8, 4);
+    map_t* flat = map_new_flat(8);
+    string_t* keys[100];
+    void* chained_values[100];
+    void* flat_values[100];
+    char text[32];
+
+    for (int64_t n = 0; n < 100; ++n) {
+        keys[n] = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+
+        // only even keys are stored, so odd keys exercise misses.
+        if (n % 2 == 0) {
+            chained = map_set(chained, keys[n], (void*) (n + 1));
+            flat = map_set(flat, keys[n], (void*) (n + 1));
+        }
+    }
+
+    map_get_many(chained, keys, 100, chained_values);
+    map_get_many(flat, keys, 100, flat_values);
+
+    for (int64_t n = 0; n < 100; ++n) {
+        TEST_ASSERT_EQUAL_PTR(n % 2 == 0 ? (void*) (n + 1) : NULL, chained_values[n]);
+        TEST_ASSERT_EQUAL_PTR(n % 2 == 0 ? (void*) (n + 1) : NULL, flat_values[n]);
+        string_free(keys[n]);
+    }
+
+    map_free(chained);
+    map_free(flat);
+}
+
+void test_map_set_should_store_entries_in_arena_chunks(void) {
+    map_t* map = map_set_numbered_keys(map_new(1024, 4), 10000);
+
+    // 10000 entries of 48 bytes fit in a handful of 64 KiB chunks.
+    TEST_ASSERT_TRUE(list_size(map->arena->chunks) <= 10);
+
+    map_free(map);
+}
+
+void test_map_delete_should_recycle_entries(void) {
+    map_t* map = map_new(8, 4);
+    char text[32];
+
+    for (int64_t n = 0; n < 100000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        map = map_set(map, key, (void*) (n + 1));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), map_delete(map, key));
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(1, list_size(map->arena->chunks));
+    TEST_ASSERT_EQUAL(0, map->arena->bytes);
+
+    map_free(map);
+}
+
+void map_foreach_sum_fn(string_t* key, void* value, void* ctx) {
+    *(int64_t*) ctx += (int64_t) value;
+}
+
+void test_map_iter_should_visit_every_pair_once(void) {
+    // 65 pairs leave the chained map part way through growing.
+    map_t* maps[] = { map_set_numbered_keys(map_new(64, 1), 65), map_set_numbered_keys(map_new_flat(4), 65) };
+
+    for (int64_t m = 0; m < 2; ++m) {
+        int64_t count = 0;
+        int64_t sum = 0;
+
+        for (map_iter_t iter = map_iter(maps[m]); map_iter_next(&iter);) {
+            char text[32];
+            int length = snprintf(text, sizeof(text), "key%" PRId64, (int64_t) iter.value - 1);
+
+            TEST_ASSERT_EQUAL(length, string_length(iter.key));
+            TEST_ASSERT_EQUAL_CHAR_ARRAY(text, string_data(iter.key), length);
+            sum += (int64_t) iter.value;
+            ++count;
+        }
+
+        TEST_ASSERT_EQUAL(65, count);
+        TEST_ASSERT_EQUAL(65 * 66 / 2, sum);
+
+        map_free(maps[m]);
+    }
+}
+
+void test_map_iter_should_visit_nothing_if_empty(void) {
+    map_t* map = map_new(4, 1);
+    map_iter_t iter = map_iter(map);
+
+    TEST_ASSERT_FALSE(map_iter_next(&iter));
+
+    map_free(map);
+}
+
+void test_map_foreach_should_pass_context(void) {
+    map_t* map = map_set_numbered_keys(map_new(8, 4), 100);
+    int64_t sum = 0;
+
+    map_foreach(map, map_foreach_sum_fn, &sum);
+
+    TEST_ASSERT_EQUAL(100 * 101 / 2, sum);
+
+    map_free(map);
+}
+
+void test_map_copy_should_clone_buckets_if_same_bucket_count(void) {
+    map_t* original = map_set_numbered_keys(map_new(64, 1), 65);
+    map_t* copy = map_copy(original, 128, 1);
+
+    TEST_ASSERT_EQUAL(128, list_size(copy->buckets));
+    TEST_ASSERT_EQUAL(65, copy->size);
+    TEST_ASSERT_TRUE(map_equal(original, copy));
+
+    for (int64_t n = 0; n < list_size(copy->buckets); ++n) {
+        list_t* bucket = list_get(original->buckets, n);
+        list_t* clone = list_get(copy->buckets, n);
+
+        TEST_ASSERT_EQUAL(bucket != NULL ? list_size(bucket) : 0, clone != NULL ? list_size(clone) : 0);
+    }
+
+    map_free(original);
+    map_free(copy);
+}
+
+void test_map_copy_should_rehash_if_different_bucket_count(void) {
+    map_t* original = map_set_numbered_keys(map_new(64, 1), 50);
+    map_t* copy = map_copy(original, 16, 4);
+
+    TEST_ASSERT_TRUE(list_size(copy->buckets) >= 16);
+    TEST_ASSERT_EQUAL(50, copy->size);
+    TEST_ASSERT_TRUE(map_equal(original, copy));
+
+    map_free(original);
+    map_free(copy);
+}
+
+void test_map_new_flat_should_set_key_to_value(void) {
+    map_t* map = map_new_flat(4);
+    string_t* key = string("hello", 5);
+    tuple_t* value = tuple_new(0, 0);
+
+    map = map_set(map, key, value);
+
+    TEST_ASSERT_EQUAL(MAP_ENGINE_FLAT, map->engine);
+    TEST_ASSERT_EQUAL_PTR(value, map_get(map, key));
+
+    map_free(map);
+    string_free(key);
+    tuple_free(value);
+}
+
+void test_map_new_flat_should_overwrite_old_value(void) {
+    map_t* map = map_new_flat(4);
+    string_t* key = string("hello", 5);
+    tuple_t* value1 = tuple_new(0, 0);
+    tuple_t* value2 = tuple_new(0, 0);
+
+    map = map_set(map_set(map, key, value1), key, value2);
+
+    TEST_ASSERT_EQUAL_PTR(value2, map_get(map, key));
+    TEST_ASSERT_EQUAL(1, map->size);
+
+    map_free(map);
+    string_free(key);
+    tuple_free(value1);
+    tuple_free(value2);
+}
+
+void test_map_new_flat_should_grow_past_initial_capacity(void) {
+    map_t* map = map_new_flat(1);
+    int64_t capacity = map->capacity;
+    char text[32];
+
+    map = map_set_numbered_keys(map, 1000);
+
+    TEST_ASSERT_EQUAL(1000, map->size);
+    TEST_ASSERT_TRUE(map->capacity > capacity);
+
+    for (int64_t n = 0; n < 1000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), map_get(map, key));
+        string_free(key);
+    }
+
+    map_free(map);
+}
+
+void test_map_new_flat_should_reuse_deleted_slots(void) {
+    map_t* map = map_new_flat(8);
+    int64_t capacity = map->capacity;
+    char text[32];
+
+    for (int64_t n = 0; n < 10000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        map = map_set(map, key, (void*) (n + 1));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), map_delete(map, key));
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(0, map->size);
+    TEST_ASSERT_EQUAL(capacity, map->capacity);
+
+    map_free(map);
+}
+
+void test_map_new_flat_delete_should_remove_element(void) {
+    map_t* map = map_new_flat(4);
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+    tuple_t* value = tuple_new(0, 0);
+
+    map = map_set(map_set(map, key1, value), key2, value);
+
+    TEST_ASSERT_EQUAL_PTR(value, map_delete(map, key1));
+    TEST_ASSERT_EQUAL_PTR(NULL, map_delete(map, key1));
+    TEST_ASSERT_EQUAL_PTR(NULL, map_get(map, key1));
+    TEST_ASSERT_EQUAL_PTR(value, map_get(map, key2));
+
+    map_free(map);
+    string_free(key1);
+    string_free(key2);
+    tuple_free(value);
+}
+
+void test_map_new_flat_clear_should_remove_all_elements(void) {
+    map_t* map = map_new_flat(4);
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+    tuple_t* value = tuple_new(0, 0);
+
+    map = map_set(map_set(map, key1, value), key2, value);
+    map = map_clear(map);
+
+    TEST_ASSERT_EQUAL(0, map->size);
+    TEST_ASSERT_EQUAL_PTR(NULL, map_get(map, key1));
+    TEST_ASSERT_EQUAL_PTR(NULL, map_get(map, key2));
+
+    map_free(map);
+    string_free(key1);
+    string_free(key2);
+    tuple_free(value);
+}
+
+void test_map_new_flat_copy_should_equal_chained_map(void) {
+    map_t* flat = map_new_flat(4);
+    map_t* chained = map_new(2, 8);
+    map_t* copy;
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+    tuple_t* value = tuple_new(0, 0);
+
+    flat = map_set(map_set(flat, key1, value), key2, value);
+    chained = map_set(map_set(chained, key1, value), key2, value);
+    copy = map_copy(flat, 2, 8);
+
+    TEST_ASSERT_EQUAL(MAP_ENGINE_FLAT, copy->engine);
+    TEST_ASSERT_TRUE(map_equal(flat, copy));
+    TEST_ASSERT_TRUE(map_equal(flat, chained));
+
+    map_free(flat);
+    map_free(chained);
+    map_free(copy);
+    string_free(key1);
+    string_free(key2);
+    tuple_free(value);
+}
+
+void test_map_set_take_should_adopt_key(void) {
+    map_t* maps[] = { map_new(2, 2), map_new_flat(4) };
+    char text[32];
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = maps[m];
+
+        for (int64_t n = 0; n < 1000; ++n) {
+            map = map_set_take(map, string(text, snprintf(text, sizeof(text), "key%" PRId64, n)), (void*) (n + 1));
+        }
+
+        // overwriting frees the duplicate key at once.
+        map = map_set_take(map, string("key7", 4), (void*) 70);
+
+        for (int64_t n = 0; n < 500; ++n) {
+            string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+            TEST_ASSERT_EQUAL_PTR(n == 7 ? (void*) 70 : (void*) (n + 1), map_delete(map, key));
+            string_free(key);
+        }
+
+        TEST_ASSERT_EQUAL(500, map->size);
+        TEST_ASSERT_EQUAL(500, map->taken);
+
+        map_t* copy = map_copy(map, 4, 2);
+        map = map_clear(map);
+
+        TEST_ASSERT_EQUAL(0, map->taken);
+        TEST_ASSERT_EQUAL(500, copy->size);
+
+        string_t* key = string("key999", 6);
+        TEST_ASSERT_EQUAL_PTR((void*) 1000, map_get(copy, key));
+        string_free(key);
+
+        map = map_set_take(map, string("hello", 5), (void*) 1);
+        map_free(map);
+        map_free(copy);
+    }
+}
+
+void test_map_set_borrowed_should_reference_key(void) {
+    map_t* maps[] = { map_new(2, 2), map_new_flat(4) };
+    string_t* key = string("hello", 5);
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = map_set_borrowed(maps[m], key, (void*) 1);
+        map_iter_t iter = map_iter(map);
+
+        TEST_ASSERT_TRUE(map_iter_next(&iter));
+        TEST_ASSERT_EQUAL_PTR(string_data(key), string_data(iter.key));
+        TEST_ASSERT_EQUAL_PTR((void*) 1, map_get(map, key));
+        TEST_ASSERT_EQUAL_PTR((void*) 1, map_delete(map, key));
+
+        map = map_set_borrowed(map, key, (void*) 2);
+        map_free(map);
+    }
+
+    TEST_ASSERT_EQUAL_MEMORY("hello", string_data(key), 5);
+
+    string_free(key);
+}
+
+void test_map_delete_take_should_return_stored_key(void) {
+    map_t* maps[] = { map_new(2, 2), map_new_flat(4) };
+    string_t* lookup = string("hello", 5);
+    string_t* missing = string("world", 5);
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = maps[m];
+        string_t* taken = string("hello", 5);
+        char* data = string_data(taken);
+        string_t* stored = NULL;
+
+        map = map_set_take(map, taken, (void*) 1);
+
+        TEST_ASSERT_EQUAL_PTR(NULL, map_delete_take(map, missing, &stored));
+        TEST_ASSERT_EQUAL_PTR(NULL, stored);
+        TEST_ASSERT_EQUAL_PTR((void*) 1, map_delete_take(map, lookup, &stored));
+        TEST_ASSERT_EQUAL_PTR(data, string_data(stored));
+        TEST_ASSERT_EQUAL(0, map->taken);
+        string_free(stored);
+
+        map = map_set(map, lookup, (void*) 2);
+
+        TEST_ASSERT_EQUAL_PTR((void*) 2, map_delete_take(map, lookup, &stored));
+        TEST_ASSERT_TRUE(string_equal(lookup, stored));
+        TEST_ASSERT_EQUAL(0, map->size);
+        string_free(stored);
+
+        map_free(map);
+    }
+
+    string_free(lookup);
+    string_free(missing);
+}
+
+void test_map_get_or_insert_should_insert_once(void) {
+    map_t* maps[] = { map_new(2, 2), map_new_flat(4) };
+    char const* words[] = { "a", "b", "a", "c", "a", "b" };
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = maps[m];
+        int64_t inserts = 0;
+
+        for (int64_t n = 0; n < 6; ++n) {
+            string_t* key = string(words[n], 1);
+            bool inserted = false;
+            void** value = map_get_or_insert(map, key, &inserted);
+
+            if (inserted) {
+                TEST_ASSERT_EQUAL_PTR(NULL, *value);
+                ++inserts;
+            }
+            *value = (void*) ((intptr_t) *value + 1);
+
+            string_free(key);
+        }
+
+        TEST_ASSERT_EQUAL(3, inserts);
+        TEST_ASSERT_EQUAL(3, map->size);
+
+        string_t* key = string("a", 1);
+        TEST_ASSERT_EQUAL_PTR((void*) 3, map_get(map, key));
+        string_free(key);
+
+        map_free(map);
+    }
+}
+
+void test_map_get_or_insert_should_keep_pointer_across_growth(void) {
+    map_t* map = map_new(2, 2);
+    string_t* key = string("first", 5);
+    bool inserted = false;
+    void** value = map_get_or_insert(map, key, &inserted);
+
+    TEST_ASSERT_TRUE(inserted);
+
+    // growth migrates the entry to a new bucket, but the entry itself stays put.
+    map = map_set_numbered_keys(map, 1000);
+    TEST_ASSERT_TRUE(map->resizes > 0);
+
+    *value = (void*) 42;
+    TEST_ASSERT_EQUAL_PTR((void*) 42, map_get(map, key));
+
+    map_free(map);
+    string_free(key);
+}
+
+void test_map_get_or_insert_should_write_through_flat_slot(void) {
+    map_t* map = map_set_numbered_keys(map_new_flat(1), 1000);
+    string_t* key = string("hello", 5);
+    char text[32];
+    bool inserted = false;
+
+    // fill the table, so the insert below grows it before handing out the slot.
+    while (map->growth_left > 0) {
+        string_t* filler = string(text, snprintf(text, sizeof(text), "filler%" PRId64, map->size));
+
+        map = map_set(map, filler, NULL);
+        string_free(filler);
+    }
+
+    int64_t resizes = map->resizes;
+    void** value = map_get_or_insert(map, key, &inserted);
+
+    TEST_ASSERT_TRUE(inserted);
+    TEST_ASSERT_TRUE(map->resizes > resizes);
+    TEST_ASSERT_EQUAL_PTR(NULL, *value);
+
+    *value = (void*) 42;
+    TEST_ASSERT_EQUAL_PTR((void*) 42, map_get(map, key));
+
+    value = map_get_or_insert(map, key, &inserted);
+
+    TEST_ASSERT_FALSE(inserted);
+    TEST_ASSERT_EQUAL_PTR((void*) 42, *value);
+
+    *value = (void*) 43;
+    TEST_ASSERT_EQUAL_PTR((void*) 43, map_get(map, key));
+    TEST_ASSERT_EQUAL_PTR((void*) 1000, map_get_bytes(map, "key999", 6));
+
+    map_free(map);
+    string_free(key);
+}
+
+void* map_update_count_fn(void* value, void* ctx) {
+    ++*(int64_t*) ctx;
+
+    return (void*) ((intptr_t) value + 1);
+}
+
+void test_map_update_should_pass_current_value(void) {
+    map_t* maps[] = { map_new(2, 2), map_new_flat(4) };
+    string_t* key = string("hello", 5);
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = maps[m];
+        int64_t calls = 0;
+
+        TEST_ASSERT_EQUAL_PTR((void*) 1, map_update(map, key, map_update_count_fn, &calls));
+        TEST_ASSERT_EQUAL_PTR((void*) 2, map_update(map, key, map_update_count_fn, &calls));
+        TEST_ASSERT_EQUAL_PTR((void*) 2, map_get(map, key));
+        TEST_ASSERT_EQUAL(2, calls);
+        TEST_ASSERT_EQUAL(1, map->size);
+
+        map_free(map);
+    }
+
+    string_free(key);
+}
+
+void test_map_get_bytes_should_lookup_key_in_place(void) {
+    map_t* maps[] = { map_new(2, 2), map_new_flat(4) };
+    char const* packet = "GET /index.html HTTP/1.1";
+    string_t* key = string("/index.html", 11);
+    string_t* empty = string("", 0);
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = map_set(map_set(maps[m], key, (void*) 1), empty, NULL);
+
+        TEST_ASSERT_EQUAL_PTR((void*) 1, map_get_bytes(map, packet + 4, 11));
+        TEST_ASSERT_EQUAL_PTR(NULL, map_get_bytes(map, packet + 4, 10));
+        TEST_ASSERT_TRUE(map_contains_bytes(map, packet + 4, 11));
+        TEST_ASSERT_TRUE(map_contains_bytes(map, packet, 0));
+        TEST_ASSERT_FALSE(map_contains_bytes(map, packet, 3));
+        TEST_ASSERT_EQUAL_PTR((void*) 1, map_delete_bytes(map, packet + 4, 11));
+        TEST_ASSERT_FALSE(map_contains_bytes(map, packet + 4, 11));
+        TEST_ASSERT_EQUAL(1, map->size);
+
+        map_free(map);
+    }
+
+    string_free(key);
+    string_free(empty);
+}
+
+void test_map_stats_should_describe_layout(void) {
+    map_t* maps[] = { map_new(4, 2), map_new_flat(4) };
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = map_set_numbered_keys(maps[m], 1000);
+        map_stats_t stats;
+
+        map_stats(map, &stats);
+
+        int64_t counted = 0;
+        for (int64_t n = 0; n < MAP_STATS_HISTOGRAM_SIZE; ++n) {
+            counted += stats.histogram[n];
+        }
+
+        // "key0" to "key999" are 10 keys of 4 bytes, 90 of 5 and 900 of 6.
+        int64_t key_bytes = 10 * 4 + 90 * 5 + 900 * 6;
+
+        TEST_ASSERT_EQUAL(1000, map_size(map));
+        TEST_ASSERT_EQUAL(1000, stats.size);
+        TEST_ASSERT_EQUAL(1000, counted);
+        TEST_ASSERT_EQUAL(1000 - stats.histogram[0], stats.collisions);
+        TEST_ASSERT_TRUE(stats.resizes > 0);
+        TEST_ASSERT_TRUE(stats.load_factor > 0 && stats.load_factor <= 1);
+        TEST_ASSERT_TRUE(stats.mean_probe_length <= stats.max_probe_length);
+        TEST_ASSERT_EQUAL(key_bytes, stats.key_bytes);
+        TEST_ASSERT_EQUAL(map->arena->bytes, stats.entry_bytes);
+        TEST_ASSERT_TRUE(stats.entry_bytes >= stats.key_bytes);
+        TEST_ASSERT_TRUE(stats.bytes > stats.entry_bytes + stats.table_bytes);
+
+        map_free(map);
+    }
+}
+
+void test_map_stats_should_describe_empty_map(void) {
+    map_t* map = map_new_flat(0);
+    map_stats_t stats;
+
+    map_stats(map, &stats);
+
+    TEST_ASSERT_EQUAL(0, map_size(map));
+    TEST_ASSERT_EQUAL(MAP_ENGINE_FLAT, stats.engine);
+    TEST_ASSERT_EQUAL(map->capacity, stats.bucket_count);
+    TEST_ASSERT_EQUAL(0, stats.max_probe_length);
+    TEST_ASSERT_EQUAL(0, stats.collisions);
+    TEST_ASSERT_EQUAL(0, stats.resizes);
+    TEST_ASSERT_EQUAL(0, stats.key_bytes);
+    TEST_ASSERT_EQUAL(0, stats.entry_bytes);
+
+    map_free(map);
+}
+
+void map_add_fn(string_t* key, void* value, void* ctx) {
+    atomic_fetch_add((_Atomic int64_t*) ctx, (intptr_t) value);
+}
+
+void test_map_foreach_parallel_should_visit_every_pair(void) {
+    // the chained map is left mid-migration after its last insert.
+    map_t* maps[] = { map_new(4, 2), map_new_flat(4) };
+
+    for (int64_t m = 0; m < 2; ++m) {
+        map_t* map = map_set_numbered_keys(maps[m], 5000);
+        _Atomic int64_t sum = 0;
+
+        map_foreach_parallel(map, map_add_fn, &sum, 0);
+        TEST_ASSERT_EQUAL(5000 * 5001 / 2, sum);
+
+        map_foreach_parallel(map, map_add_fn, &sum, 1);
+        TEST_ASSERT_EQUAL(5000 * 5001, sum);
+
+        map_free(map);
+    }
+}
+
 int main(void) {
     UNITY_BEGIN();
 
     RUN_TEST(test_map_copy_should_return_a_new_copy);
     RUN_TEST(test_map_copy_should_not_modify_original);
     RUN_TEST(test_map_copy_should_create_copy_equal_to_original);
+    RUN_TEST(test_map_copy_should_clone_buckets_if_same_bucket_count);
+    RUN_TEST(test_map_copy_should_rehash_if_different_bucket_count);
 
     RUN_TEST(test_map_clear_should_remove_all_elements);
     RUN_TEST(test_map_set_should_overwrite_old_value);
     RUN_TEST(test_map_set_should_set_key_to_value);
+    RUN_TEST(test_map_set_should_grow_bucket_count);
+    RUN_TEST(test_map_set_should_migrate_buckets_incrementally);
+    RUN_TEST(test_map_set_should_store_entries_in_arena_chunks);
+    RUN_TEST(test_map_set_borrowed_should_reference_key);
+    RUN_TEST(test_map_set_take_should_adopt_key);
     
     RUN_TEST(test_map_equal_should_return_false_if_different_keys);
     RUN_TEST(test_map_equal_should_return_false_if_different_pairs);
@@ -289,11 +966,35 @@ int main(void) {
     RUN_TEST(test_map_equal_should_return_true_if_same_elements);
     RUN_TEST(test_map_equal_should_return_true_if_same_identity);
 
+    RUN_TEST(test_map_delete_should_recycle_entries);
+    RUN_TEST(test_map_delete_take_should_return_stored_key);
     RUN_TEST(test_map_delete_should_remove_element);
     RUN_TEST(test_map_delete_should_return_element_if_key_found);
     RUN_TEST(test_map_delete_should_return_null_if_key_not_found);
     RUN_TEST(test_map_get_should_return_null_if_key_not_found);
     RUN_TEST(test_map_get_should_return_value_if_key_found);
+    RUN_TEST(test_map_get_bytes_should_lookup_key_in_place);
+    RUN_TEST(test_map_get_hashed_should_return_value_set_hashed);
+    RUN_TEST(test_map_get_many_should_return_value_for_each_key);
+    RUN_TEST(test_map_get_or_insert_should_insert_once);
+    RUN_TEST(test_map_get_or_insert_should_keep_pointer_across_growth);
+    RUN_TEST(test_map_get_or_insert_should_write_through_flat_slot);
+    RUN_TEST(test_map_update_should_pass_current_value);
+
+    RUN_TEST(test_map_foreach_parallel_should_visit_every_pair);
+    RUN_TEST(test_map_foreach_should_pass_context);
+    RUN_TEST(test_map_iter_should_visit_every_pair_once);
+    RUN_TEST(test_map_iter_should_visit_nothing_if_empty);
+    RUN_TEST(test_map_stats_should_describe_empty_map);
+    RUN_TEST(test_map_stats_should_describe_layout);
+
+    RUN_TEST(test_map_new_flat_clear_should_remove_all_elements);
+    RUN_TEST(test_map_new_flat_copy_should_equal_chained_map);
+    RUN_TEST(test_map_new_flat_delete_should_remove_element);
+    RUN_TEST(test_map_new_flat_should_grow_past_initial_capacity);
+    RUN_TEST(test_map_new_flat_should_overwrite_old_value);
+    RUN_TEST(test_map_new_flat_should_reuse_deleted_slots);
+    RUN_TEST(test_map_new_flat_should_set_key_to_value);
 
     UNITY_END();
 }
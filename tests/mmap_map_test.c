@@ -0,0 +1,262 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cstrings.h"
+#include "map.h"
+#include "mmap_map.h"
+
+// each test saves into a fresh temporary directory, wherever the tests run from.
+static char mmap_map_test_dir[] = "/tmp/mmap_map_test.XXXXXX";
+static char mmap_map_test_path[sizeof(mmap_map_test_dir) + 16];
+
+void setUp(void) {
+    strcpy(mmap_map_test_dir + sizeof(mmap_map_test_dir) - 7, "XXXXXX");
+    TEST_ASSERT_NOT_NULL(mkdtemp(mmap_map_test_dir));
+    snprintf(mmap_map_test_path, sizeof(mmap_map_test_path), "%s/map.bin", mmap_map_test_dir);
+}
+
+void tearDown(void) {
+    remove(mmap_map_test_path);
+    rmdir(mmap_map_test_dir);
+}
+
+// map_set_numbered_values stores count numbered keys, each with a string value numbered n + 1.
+map_t* map_set_numbered_values(map_t* map, int64_t count) {
+    char text[32];
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        map = map_set(map, key, string(text, snprintf(text, sizeof(text), "value%" PRId64, n + 1)));
+        string_free(key);
+    }
+
+    return map;
+}
+
+void map_free_values(map_t* map) {
+    for (map_iter_t iter = map_iter(map); map_iter_next(&iter);) {
+        string_free(iter.value);
+    }
+
+    map_free(map);
+}
+
+void assert_mmap_map_values(mmap_map_t* mapped, int64_t count) {
+    char text[32];
+    char expected[32];
+    int64_t length = 0;
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        char const* value = mmap_map_get(mapped, key, &length);
+
+        TEST_ASSERT_EQUAL(snprintf(expected, sizeof(expected), "value%" PRId64, n + 1), length);
+        TEST_ASSERT_EQUAL_MEMORY(expected, value, length);
+        string_free(key);
+    }
+}
+
+void test_map_open_mmap_should_return_every_pair(void) {
+    map_t* map = map_set_numbered_values(map_new_flat(64), 10000);
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free_values(map);
+
+    mmap_map_t* mapped = map_open_mmap(mmap_map_test_path);
+
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_EQUAL(10000, mmap_map_size(mapped));
+    assert_mmap_map_values(mapped, 10000);
+
+    mmap_map_close(mapped);
+}
+
+void test_map_open_mmap_should_return_null_if_key_not_found(void) {
+    map_t* map = map_set_numbered_values(map_new(64, 4), 1000);
+    char text[32];
+    int64_t length = -1;
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free_values(map);
+
+    mmap_map_t* mapped = map_open_mmap(mmap_map_test_path);
+
+    for (int64_t n = 1000; n < 2000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR(NULL, mmap_map_get(mapped, key, &length));
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(-1, length);
+
+    mmap_map_close(mapped);
+}
+
+void test_map_open_mmap_should_return_empty_map_if_empty(void) {
+    map_t* map = map_new(4, 4);
+    string_t* key = string("hello", 5);
+    int64_t length = 0;
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free(map);
+
+    mmap_map_t* mapped = map_open_mmap(mmap_map_test_path);
+
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_EQUAL(0, mmap_map_size(mapped));
+    TEST_ASSERT_EQUAL_PTR(NULL, mmap_map_get(mapped, key, &length));
+
+    mmap_map_close(mapped);
+    string_free(key);
+}
+
+void test_map_save_should_not_disturb_mapped_file(void) {
+    map_t* map = map_set_numbered_values(map_new_flat(64), 1000);
+    map_t* other = map_new(4, 4);
+    string_t* key = string("hello", 5);
+    int64_t length = 0;
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free_values(map);
+
+    mmap_map_t* mapped = map_open_mmap(mmap_map_test_path);
+
+    // the smaller file replaces the old one without truncating it under the mapping.
+    other = map_set(other, key, string("world", 5));
+    TEST_ASSERT_TRUE(map_save(other, mmap_map_test_path));
+    map_free_values(other);
+
+    assert_mmap_map_values(mapped, 1000);
+
+    mmap_map_t* reopened = map_open_mmap(mmap_map_test_path);
+
+    TEST_ASSERT_EQUAL(1, mmap_map_size(reopened));
+    TEST_ASSERT_EQUAL_MEMORY("world", mmap_map_get(reopened, key, &length), 5);
+
+    mmap_map_close(mapped);
+    mmap_map_close(reopened);
+    string_free(key);
+}
+
+void test_map_open_mmap_should_return_null_if_file_invalid(void) {
+    char garbage[256];
+
+    TEST_ASSERT_EQUAL_PTR(NULL, map_open_mmap(mmap_map_test_path));
+
+    FILE* file = fopen(mmap_map_test_path, "wb");
+    memset(garbage, 0x5A, sizeof(garbage));
+    fwrite(garbage, 1, sizeof(garbage), file);
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, map_open_mmap(mmap_map_test_path));
+}
+
+void test_map_open_mmap_should_return_null_if_file_truncated(void) {
+    map_t* map = map_set_numbered_values(map_new_flat(64), 100);
+    char buf[8192];
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free_values(map);
+
+    FILE* file = fopen(mmap_map_test_path, "rb");
+    int64_t length = fread(buf, 1, sizeof(buf), file);
+    fclose(file);
+
+    file = fopen(mmap_map_test_path, "wb");
+    fwrite(buf, 1, length - 1, file);
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, map_open_mmap(mmap_map_test_path));
+}
+
+void test_map_open_mmap_should_return_null_if_slot_corrupt(void) {
+    map_t* map = map_new(4, 4);
+    string_t* key1 = string("hello", 5);
+    string_t* key2 = string("world", 5);
+    mmap_map_header_t header;
+    mmap_map_slot_t slots[3];
+
+    map = map_set(map, key1, string("a", 1));
+    map = map_set(map, key2, string("b", 1));
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free_values(map);
+
+    FILE* file = fopen(mmap_map_test_path, "r+b");
+    fread(&header, sizeof(header), 1, file);
+    fseek(file, header.slots_offset, SEEK_SET);
+    fread(slots, sizeof(mmap_map_slot_t), 3, file);
+
+    // a key running past the data section is rejected.
+    slots[0].key_length = header.data_length + 1;
+    fseek(file, header.slots_offset, SEEK_SET);
+    fwrite(slots, sizeof(mmap_map_slot_t), 3, file);
+    fflush(file);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, map_open_mmap(mmap_map_test_path));
+
+    // so are offsets running backwards.
+    slots[0].key_length = 5;
+    slots[1].offset = slots[0].offset - 1;
+    fseek(file, header.slots_offset, SEEK_SET);
+    fwrite(slots, sizeof(mmap_map_slot_t), 3, file);
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, map_open_mmap(mmap_map_test_path));
+
+    string_free(key1);
+    string_free(key2);
+}
+
+void test_map_open_mmap_should_return_null_if_size_overflows(void) {
+    map_t* map = map_set_numbered_values(map_new_flat(64), 100);
+    mmap_map_header_t header;
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    map_free_values(map);
+
+    FILE* file = fopen(mmap_map_test_path, "r+b");
+    fread(&header, sizeof(header), 1, file);
+
+    // size + 1 would wrap around to a negative slot count.
+    header.size = INT64_MAX;
+    fseek(file, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file);
+    fclose(file);
+
+    TEST_ASSERT_EQUAL_PTR(NULL, map_open_mmap(mmap_map_test_path));
+}
+
+void test_map_save_should_keep_file_mode(void) {
+    map_t* map = map_new(4, 4);
+    struct stat info;
+
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    TEST_ASSERT_EQUAL(0, chmod(mmap_map_test_path, 0640));
+    TEST_ASSERT_TRUE(map_save(map, mmap_map_test_path));
+    TEST_ASSERT_EQUAL(0, stat(mmap_map_test_path, &info));
+    TEST_ASSERT_EQUAL(0640, info.st_mode & 07777);
+
+    map_free(map);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_map_open_mmap_should_return_empty_map_if_empty);
+    RUN_TEST(test_map_open_mmap_should_return_every_pair);
+    RUN_TEST(test_map_open_mmap_should_return_null_if_file_invalid);
+    RUN_TEST(test_map_open_mmap_should_return_null_if_file_truncated);
+    RUN_TEST(test_map_open_mmap_should_return_null_if_key_not_found);
+    RUN_TEST(test_map_open_mmap_should_return_null_if_size_overflows);
+    RUN_TEST(test_map_open_mmap_should_return_null_if_slot_corrupt);
+    RUN_TEST(test_map_save_should_keep_file_mode);
+    RUN_TEST(test_map_save_should_not_disturb_mapped_file);
+
+    return UNITY_END();
+}
@@ -0,0 +1,210 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "cstrings.h"
+#include "pmap.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// pmap_set_numbered_keys stores count numbered keys, keeping only the newest version.
+pmap_t* pmap_set_numbered_keys(pmap_t* map, int64_t count) {
+    char text[32];
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        pmap_t* next = pmap_set(map, key, (void*) (n + 1));
+
+        pmap_free(map);
+        map = next;
+        string_free(key);
+    }
+
+    return map;
+}
+
+void test_pmap_set_should_return_new_version(void) {
+    pmap_t* empty = pmap_new();
+    string_t* key = string("hello", 5);
+    pmap_t* first = pmap_set(empty, key, (void*) 1);
+    pmap_t* second = pmap_set(first, key, (void*) 2);
+
+    TEST_ASSERT_EQUAL(0, pmap_size(empty));
+    TEST_ASSERT_EQUAL_PTR(NULL, pmap_get(empty, key));
+    TEST_ASSERT_EQUAL(1, pmap_size(first));
+    TEST_ASSERT_EQUAL_PTR((void*) 1, pmap_get(first, key));
+    TEST_ASSERT_EQUAL(1, pmap_size(second));
+    TEST_ASSERT_EQUAL_PTR((void*) 2, pmap_get(second, key));
+
+    pmap_free(empty);
+    pmap_free(first);
+    pmap_free(second);
+    string_free(key);
+}
+
+void test_pmap_set_should_keep_every_pair(void) {
+    pmap_t* map = pmap_set_numbered_keys(pmap_new(), 10000);
+    string_t* missing = string("key10000", 8);
+    char text[32];
+
+    TEST_ASSERT_EQUAL(10000, pmap_size(map));
+
+    for (int64_t n = 0; n < 10000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), pmap_get(map, key));
+        string_free(key);
+    }
+    TEST_ASSERT_EQUAL_PTR(NULL, pmap_get(map, missing));
+
+    pmap_free(map);
+    string_free(missing);
+}
+
+void test_pmap_set_should_share_untouched_nodes(void) {
+    pmap_t* old = pmap_set_numbered_keys(pmap_new(), 1000);
+    string_t* key = string("key0", 4);
+    string_t* other = string("key499", 6);
+    pmap_t* new = pmap_set(old, key, (void*) 42);
+    pmap_branch_t* old_root = (pmap_branch_t*) old->root;
+    pmap_branch_t* new_root = (pmap_branch_t*) new->root;
+    int64_t shared = 0;
+
+    TEST_ASSERT_EQUAL(PMAP_BRANCH, old->root->kind);
+    TEST_ASSERT_EQUAL(old_root->bitmap, new_root->bitmap);
+
+    for (int n = 0; n < __builtin_popcount(old_root->bitmap); ++n) {
+        shared += old_root->children[n] == new_root->children[n];
+    }
+
+    TEST_ASSERT_EQUAL(__builtin_popcount(old_root->bitmap) - 1, shared);
+    TEST_ASSERT_EQUAL_PTR((void*) 1, pmap_get(old, key));
+    TEST_ASSERT_EQUAL_PTR((void*) 42, pmap_get(new, key));
+
+    pmap_free(old);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 500, pmap_get(new, other));
+
+    pmap_free(new);
+    string_free(key);
+    string_free(other);
+}
+
+void test_pmap_snapshot_should_return_same_version(void) {
+    pmap_t* empty = pmap_new();
+    string_t* key = string("hello", 5);
+    pmap_t* map = pmap_set(empty, key, (void*) 1);
+    pmap_t* snapshot = pmap_snapshot(map);
+
+    TEST_ASSERT_EQUAL_PTR(map, snapshot);
+
+    pmap_free(empty);
+    pmap_free(map);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 1, pmap_get(snapshot, key));
+
+    pmap_free(snapshot);
+    string_free(key);
+}
+
+void test_pmap_delete_should_remove_pairs(void) {
+    pmap_t* map = pmap_set_numbered_keys(pmap_new(), 2000);
+    pmap_t* full = pmap_snapshot(map);
+    char text[32];
+
+    for (int64_t n = 0; n < 2000; n += 2) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        pmap_t* next = pmap_delete(map, key);
+
+        pmap_free(map);
+        map = next;
+        string_free(key);
+    }
+
+    TEST_ASSERT_EQUAL(1000, pmap_size(map));
+    TEST_ASSERT_EQUAL(2000, pmap_size(full));
+
+    for (int64_t n = 0; n < 2000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR(n % 2 == 1 ? (void*) (n + 1) : NULL, pmap_get(map, key));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), pmap_get(full, key));
+        string_free(key);
+    }
+
+    string_t* missing = string("missing", 7);
+    pmap_t* same = pmap_delete(map, missing);
+
+    TEST_ASSERT_EQUAL_PTR(map, same);
+
+    pmap_free(same);
+    pmap_free(map);
+    pmap_free(full);
+    string_free(missing);
+}
+
+void test_pmap_should_handle_full_hash_collisions(void) {
+    string_t* keys[] = { string("a", 1), string("b", 1), string("c", 1) };
+    pmap_t* map = pmap_new();
+
+    // keys hash lazily, so a preset hash forces them to collide.
+    for (int n = 0; n < 3; ++n) {
+        keys[n]->hash = 0x1234;
+
+        pmap_t* next = pmap_set(map, keys[n], (void*) (intptr_t) (n + 1));
+        pmap_free(map);
+        map = next;
+    }
+
+    TEST_ASSERT_EQUAL(3, pmap_size(map));
+    TEST_ASSERT_EQUAL(PMAP_COLLISION, map->root->kind);
+
+    for (int n = 0; n < 3; ++n) {
+        TEST_ASSERT_EQUAL_PTR((void*) (intptr_t) (n + 1), pmap_get(map, keys[n]));
+    }
+
+    for (int n = 0; n < 2; ++n) {
+        pmap_t* next = pmap_delete(map, keys[n]);
+        pmap_free(map);
+        map = next;
+    }
+
+    TEST_ASSERT_EQUAL(1, pmap_size(map));
+    TEST_ASSERT_EQUAL(PMAP_LEAF, map->root->kind);
+    TEST_ASSERT_EQUAL_PTR((void*) 3, pmap_get(map, keys[2]));
+
+    pmap_free(map);
+    for (int n = 0; n < 3; ++n) {
+        string_free(keys[n]);
+    }
+}
+
+void pmap_count_fn(string_t* key, void* value, void* ctx) {
+    *(int64_t*) ctx += (intptr_t) value;
+}
+
+void test_pmap_foreach_should_visit_every_pair(void) {
+    pmap_t* map = pmap_set_numbered_keys(pmap_new(), 100);
+    int64_t sum = 0;
+
+    pmap_foreach(map, pmap_count_fn, &sum);
+
+    TEST_ASSERT_EQUAL(5050, sum);
+
+    pmap_free(map);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_pmap_delete_should_remove_pairs);
+    RUN_TEST(test_pmap_foreach_should_visit_every_pair);
+    RUN_TEST(test_pmap_set_should_keep_every_pair);
+    RUN_TEST(test_pmap_set_should_return_new_version);
+    RUN_TEST(test_pmap_set_should_share_untouched_nodes);
+    RUN_TEST(test_pmap_should_handle_full_hash_collisions);
+    RUN_TEST(test_pmap_snapshot_should_return_same_version);
+
+    return UNITY_END();
+}
@@ -0,0 +1,191 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "cstrings.h"
+#include "rcu_map.h"
+
+#define READER_COUNT 4
+#define KEY_COUNT 64
+#define WRITE_ROUNDS 200
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+typedef struct reader_args_t {
+    rcu_map_t* map;
+    atomic_bool* done;
+    int64_t bad_values;
+} reader_args_t;
+
+void* reader_lookup_until_done(void* arg) {
+    reader_args_t* args = arg;
+    rcu_map_reader_t* reader = rcu_map_reader_register(args->map);
+    string_t* keys[KEY_COUNT];
+    char text[16];
+
+    for (int64_t n = 0; n < KEY_COUNT; ++n) {
+        keys[n] = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+    }
+
+    while (!atomic_load(args->done)) {
+        for (int64_t n = 0; n < KEY_COUNT; ++n) {
+            int64_t value = (int64_t) rcu_map_get(args->map, keys[n]);
+
+            // values always encode their key, whichever version is observed.
+            if (value != 0 && value % KEY_COUNT != n) {
+                ++args->bad_values;
+            }
+        }
+
+        rcu_map_quiescent(args->map, reader);
+    }
+
+    for (int64_t n = 0; n < KEY_COUNT; ++n) {
+        string_free(keys[n]);
+    }
+    rcu_map_reader_unregister(args->map, reader);
+
+    return NULL;
+}
+
+void test_rcu_map_set_should_set_key_to_value(void) {
+    rcu_map_t* map = rcu_map_new(2);
+    string_t* key = string("hello", 5);
+    int value1 = 0;
+    int value2 = 0;
+
+    map = rcu_map_set(map, key, &value1);
+    TEST_ASSERT_EQUAL_PTR(&value1, rcu_map_get(map, key));
+
+    map = rcu_map_set(map, key, &value2);
+    TEST_ASSERT_EQUAL_PTR(&value2, rcu_map_get(map, key));
+    TEST_ASSERT_EQUAL(1, map->size);
+
+    rcu_map_free(map);
+    string_free(key);
+}
+
+void test_rcu_map_set_should_grow_bucket_count(void) {
+    rcu_map_t* map = rcu_map_new(2);
+    char text[16];
+
+    for (int64_t n = 0; n < 1000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        map = rcu_map_set(map, key, (void*) (n + 1));
+        string_free(key);
+    }
+
+    TEST_ASSERT_TRUE(atomic_load(&map->table)->bucket_count >= 1000);
+
+    for (int64_t n = 0; n < 1000; ++n) {
+        string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), rcu_map_get(map, key));
+        string_free(key);
+    }
+
+    rcu_map_free(map);
+}
+
+void test_rcu_map_delete_should_return_element_if_key_found(void) {
+    rcu_map_t* map = rcu_map_new(2);
+    string_t* key = string("hello", 5);
+    int value = 0;
+
+    map = rcu_map_set(map, key, &value);
+
+    TEST_ASSERT_EQUAL_PTR(&value, rcu_map_delete(map, key));
+    TEST_ASSERT_EQUAL_PTR(NULL, rcu_map_delete(map, key));
+    TEST_ASSERT_EQUAL_PTR(NULL, rcu_map_get(map, key));
+
+    rcu_map_free(map);
+    string_free(key);
+}
+
+void test_rcu_map_should_not_write_to_keys(void) {
+    rcu_map_t* map = rcu_map_new(2);
+    string_t* key = string("hello", 5);
+    int value = 0;
+
+    rcu_map_set(map, key, &value);
+    TEST_ASSERT_EQUAL_PTR(&value, rcu_map_get(map, key));
+    TEST_ASSERT_EQUAL_PTR(&value, rcu_map_delete(map, key));
+    TEST_ASSERT_EQUAL(0, key->hash);
+
+    rcu_map_free(map);
+    string_free(key);
+}
+
+void test_rcu_map_reclaim_should_wait_for_quiescent_readers(void) {
+    rcu_map_t* map = rcu_map_new(2);
+    rcu_map_reader_t* reader = rcu_map_reader_register(map);
+    string_t* key = string("hello", 5);
+    int value = 0;
+
+    map = rcu_map_set(map, key, &value);
+    map = rcu_map_set(map, key, &value);
+
+    TEST_ASSERT_TRUE(rcu_map_reclaim(map) > 0);
+
+    rcu_map_quiescent(map, reader);
+
+    TEST_ASSERT_EQUAL(0, rcu_map_reclaim(map));
+
+    rcu_map_reader_unregister(map, reader);
+    rcu_map_free(map);
+    string_free(key);
+}
+
+void test_rcu_map_get_should_be_safe_during_writes(void) {
+    rcu_map_t* map = rcu_map_new(4);
+    atomic_bool done = false;
+    pthread_t threads[READER_COUNT];
+    reader_args_t args[READER_COUNT];
+    char text[16];
+
+    for (int64_t n = 0; n < READER_COUNT; ++n) {
+        args[n] = (reader_args_t) { .map = map, .done = &done, .bad_values = 0 };
+        pthread_create(&threads[n], NULL, reader_lookup_until_done, &args[n]);
+    }
+
+    for (int64_t round = 1; round <= WRITE_ROUNDS; ++round) {
+        for (int64_t n = 0; n < KEY_COUNT; ++n) {
+            string_t* key = string(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+
+            if ((round + n) % 3 == 0) {
+                rcu_map_delete(map, key);
+            } else {
+                rcu_map_set(map, key, (void*) (round * KEY_COUNT + n));
+            }
+            string_free(key);
+        }
+    }
+
+    atomic_store(&done, true);
+    for (int64_t n = 0; n < READER_COUNT; ++n) {
+        pthread_join(threads[n], NULL);
+        TEST_ASSERT_EQUAL(0, args[n].bad_values);
+    }
+
+    TEST_ASSERT_EQUAL(0, rcu_map_reclaim(map));
+
+    rcu_map_free(map);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rcu_map_delete_should_return_element_if_key_found);
+    RUN_TEST(test_rcu_map_set_should_grow_bucket_count);
+    RUN_TEST(test_rcu_map_set_should_set_key_to_value);
+    RUN_TEST(test_rcu_map_should_not_write_to_keys);
+
+    RUN_TEST(test_rcu_map_get_should_be_safe_during_writes);
+    RUN_TEST(test_rcu_map_reclaim_should_wait_for_quiescent_readers);
+
+    return UNITY_END();
+}
@@ -0,0 +1,188 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "cstrings.h"
+#include "set.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+set_t* set_of(char const** keys, int64_t count) {
+    set_t* set = set_new(4);
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t key = string_view(keys[n], strlen(keys[n]));
+        set_add(set, &key);
+    }
+
+    return set;
+}
+
+bool set_contains_text(set_t* set, char const* text) {
+    string_t key = string_view(text, strlen(text));
+
+    return set_contains(set, &key);
+}
+
+void set_add_numbered_keys(set_t* set, int64_t count) {
+    char text[32];
+
+    for (int64_t n = 0; n < count; ++n) {
+        string_t key = string_view(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        set_add(set, &key);
+    }
+}
+
+void test_set_add_should_add_key_once(void) {
+    set_t* set = set_new(4);
+    string_t* key = string("hello", 5);
+    string_t* empty = string("", 0);
+
+    TEST_ASSERT_TRUE(set_add(set, key));
+    TEST_ASSERT_FALSE(set_add(set, key));
+    TEST_ASSERT_TRUE(set_add(set, empty));
+    TEST_ASSERT_TRUE(set_contains(set, key));
+    TEST_ASSERT_TRUE(set_contains(set, empty));
+    TEST_ASSERT_EQUAL(2, set_size(set));
+
+    set_free(set);
+    string_free(key);
+    string_free(empty);
+}
+
+void test_set_add_should_grow_past_initial_capacity(void) {
+    set_t* set = set_new(1);
+    char text[32];
+
+    set_add_numbered_keys(set, 10000);
+
+    TEST_ASSERT_EQUAL(10000, set_size(set));
+
+    for (int64_t n = 0; n < 10000; ++n) {
+        string_t key = string_view(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_TRUE(set_contains(set, &key));
+    }
+    TEST_ASSERT_FALSE(set_contains_text(set, "key10000"));
+
+    set_free(set);
+}
+
+void test_set_remove_should_keep_other_keys_reachable(void) {
+    set_t* set = set_new(1);
+    char text[32];
+
+    set_add_numbered_keys(set, 10000);
+
+    for (int64_t n = 0; n < 10000; n += 2) {
+        string_t key = string_view(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_TRUE(set_remove(set, &key));
+        TEST_ASSERT_FALSE(set_remove(set, &key));
+    }
+
+    TEST_ASSERT_EQUAL(5000, set_size(set));
+
+    for (int64_t n = 0; n < 10000; ++n) {
+        string_t key = string_view(text, snprintf(text, sizeof(text), "key%" PRId64, n));
+        TEST_ASSERT_EQUAL(n % 2 == 1, set_contains(set, &key));
+    }
+
+    set_free(set);
+}
+
+void test_set_clear_should_remove_all_keys(void) {
+    char const* keys[] = { "hello", "world" };
+    set_t* set = set_of(keys, 2);
+
+    set = set_clear(set);
+
+    TEST_ASSERT_EQUAL(0, set_size(set));
+    TEST_ASSERT_FALSE(set_contains_text(set, "hello"));
+
+    set_iter_t iter = set_iter(set);
+    TEST_ASSERT_FALSE(set_iter_next(&iter));
+
+    set_free(set);
+}
+
+void test_set_copy_should_not_share_lifetime(void) {
+    char const* keys[] = { "hello", "world" };
+    set_t* set = set_of(keys, 2);
+    set_t* copy = set_copy(set);
+
+    set_free(set);
+
+    TEST_ASSERT_EQUAL(2, set_size(copy));
+    TEST_ASSERT_TRUE(set_contains_text(copy, "hello"));
+    TEST_ASSERT_TRUE(set_contains_text(copy, "world"));
+
+    set_free(copy);
+}
+
+void test_set_algebra_should_combine_keys(void) {
+    char const* small_keys[] = { "a", "b", "c" };
+    char const* large_keys[] = { "b", "c", "d", "e", "f" };
+    set_t* small = set_of(small_keys, 3);
+    set_t* large = set_of(large_keys, 5);
+    set_t* unions[] = { set_union(small, large), set_union(large, small) };
+    set_t* intersections[] = { set_intersect(small, large), set_intersect(large, small) };
+    set_t* small_minus_large = set_difference(small, large);
+    set_t* large_minus_small = set_difference(large, small);
+
+    for (int64_t m = 0; m < 2; ++m) {
+        TEST_ASSERT_EQUAL(6, set_size(unions[m]));
+        TEST_ASSERT_EQUAL(2, set_size(intersections[m]));
+        TEST_ASSERT_TRUE(set_contains_text(unions[m], "a"));
+        TEST_ASSERT_TRUE(set_contains_text(unions[m], "f"));
+        TEST_ASSERT_TRUE(set_contains_text(intersections[m], "b"));
+        TEST_ASSERT_FALSE(set_contains_text(intersections[m], "a"));
+
+        set_free(unions[m]);
+        set_free(intersections[m]);
+    }
+
+    // the two differences take the rebuild and copy paths respectively.
+    TEST_ASSERT_EQUAL(1, set_size(small_minus_large));
+    TEST_ASSERT_TRUE(set_contains_text(small_minus_large, "a"));
+    TEST_ASSERT_EQUAL(3, set_size(large_minus_small));
+    TEST_ASSERT_TRUE(set_contains_text(large_minus_small, "d"));
+    TEST_ASSERT_FALSE(set_contains_text(large_minus_small, "b"));
+
+    set_free(small);
+    set_free(large);
+    set_free(small_minus_large);
+    set_free(large_minus_small);
+}
+
+void test_set_iter_should_visit_every_key_once(void) {
+    set_t* set = set_new(4);
+    set_t* seen = set_new(4);
+
+    set_add_numbered_keys(set, 1000);
+
+    for (set_iter_t iter = set_iter(set); set_iter_next(&iter);) {
+        TEST_ASSERT_TRUE(set_add(seen, iter.key));
+    }
+
+    TEST_ASSERT_EQUAL(1000, set_size(seen));
+
+    set_free(set);
+    set_free(seen);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_set_add_should_add_key_once);
+    RUN_TEST(test_set_add_should_grow_past_initial_capacity);
+    RUN_TEST(test_set_algebra_should_combine_keys);
+    RUN_TEST(test_set_clear_should_remove_all_keys);
+    RUN_TEST(test_set_copy_should_not_share_lifetime);
+    RUN_TEST(test_set_iter_should_visit_every_key_once);
+    RUN_TEST(test_set_remove_should_keep_other_keys_reachable);
+
+    return UNITY_END();
+}
@@ -0,0 +1,90 @@
+#include "unity.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+
+#include "cstrings.h"
+#include "list.h"
+#include "string_intern.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_string_intern_should_return_same_instance_for_same_data(void) {
+    string_intern_t* intern = string_intern_new(4);
+    string_t* str = string("hello", 5);
+
+    string_t* a = string_intern(intern, "hello", 5);
+    string_t* b = string_intern_string(intern, str);
+
+    TEST_ASSERT_EQUAL_PTR(a, b);
+    TEST_ASSERT_EQUAL_PTR(a, string_intern_string(intern, a));
+    TEST_ASSERT_EQUAL(1, string_intern_size(intern));
+    TEST_ASSERT_EQUAL(string_hash(str), a->hash);
+
+    string_intern_free(intern);
+    string_free(str);
+}
+
+void test_string_intern_should_return_distinct_instances_for_distinct_data(void) {
+    string_intern_t* intern = string_intern_new(4);
+
+    string_t* a = string_intern(intern, "hello", 5);
+    string_t* b = string_intern(intern, "hell", 4);
+    string_t* c = string_intern(intern, "", 0);
+
+    TEST_ASSERT_NOT_EQUAL(a, b);
+    TEST_ASSERT_NOT_EQUAL(a, c);
+    TEST_ASSERT_FALSE(string_equal(a, b));
+    TEST_ASSERT_EQUAL(0, string_length(c));
+    TEST_ASSERT_EQUAL(3, string_intern_size(intern));
+
+    string_intern_free(intern);
+}
+
+void test_string_intern_should_keep_instances_while_growing(void) {
+    string_intern_t* intern = string_intern_new(1);
+    string_t* first[10000];
+    char text[16];
+
+    for (int64_t n = 0; n < 10000; ++n) {
+        first[n] = string_intern(intern, text, snprintf(text, sizeof(text), "key%" PRId64, n));
+    }
+
+    TEST_ASSERT_EQUAL(10000, string_intern_size(intern));
+
+    for (int64_t n = 0; n < 10000; ++n) {
+        int64_t length = snprintf(text, sizeof(text), "key%" PRId64, n);
+        TEST_ASSERT_EQUAL_PTR(first[n], string_intern(intern, text, length));
+        TEST_ASSERT_EQUAL_MEMORY(text, string_data(first[n]), length);
+    }
+
+    string_intern_free(intern);
+}
+
+void test_string_intern_should_allow_list_find_by_pointer(void) {
+    string_intern_t* intern = string_intern_new(4);
+    list_t* list = list_new(4);
+
+    list = list_append(list, string_intern(intern, "a", 1));
+    list = list_append(list, string_intern(intern, "b", 1));
+    list = list_append(list, string_intern(intern, "c", 1));
+
+    TEST_ASSERT_EQUAL(1, list_find(list, string_intern(intern, "b", 1)));
+    TEST_ASSERT_EQUAL(-1, list_find(list, string_intern(intern, "d", 1)));
+
+    list_free(list);
+    string_intern_free(intern);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_string_intern_should_allow_list_find_by_pointer);
+    RUN_TEST(test_string_intern_should_keep_instances_while_growing);
+    RUN_TEST(test_string_intern_should_return_distinct_instances_for_distinct_data);
+    RUN_TEST(test_string_intern_should_return_same_instance_for_same_data);
+
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+#include "unity.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+#include "thread_pool.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void thread_pool_count_fn(int64_t start, int64_t end, void* ctx) {
+    _Atomic int64_t* counts = ctx;
+
+    for (int64_t n = start; n < end; ++n) {
+        atomic_fetch_add(&counts[n], 1);
+    }
+}
+
+void test_thread_pool_for_should_visit_every_index_once(void) {
+    thread_pool_t* pool = thread_pool_new(4);
+    int64_t sizes[] = { 0, 1, 7, 1000, 100003 };
+    int64_t grains[] = { 0, 1, 3, 64, 100000 };
+
+    TEST_ASSERT_EQUAL(4, thread_pool_size(pool));
+
+    for (int s = 0; s < 5; ++s) {
+        for (int g = 0; g < 5; ++g) {
+            _Atomic int64_t* counts = calloc(sizes[s] + 1, sizeof(_Atomic int64_t));
+
+            thread_pool_for(pool, sizes[s], grains[g], thread_pool_count_fn, counts);
+
+            for (int64_t n = 0; n < sizes[s]; ++n) {
+                TEST_ASSERT_EQUAL(1, counts[n]);
+            }
+
+            free(counts);
+        }
+    }
+
+    thread_pool_free(pool);
+}
+
+typedef struct thread_pool_skew_t {
+    _Atomic int64_t sum;
+} thread_pool_skew_t;
+
+void thread_pool_skew_fn(int64_t start, int64_t end, void* ctx) {
+    thread_pool_skew_t* skew = ctx;
+    int64_t sum = 0;
+
+    // the first chunks take far longer, so other threads must steal them.
+    for (int64_t n = start; n < end; ++n) {
+        int64_t work = n < 16 ? 200000 : 10;
+
+        for (volatile int64_t w = 0; w < work; ++w) {}
+        sum += n;
+    }
+
+    atomic_fetch_add(&skew->sum, sum);
+}
+
+void test_thread_pool_for_should_finish_uneven_chunks(void) {
+    thread_pool_t* pool = thread_pool_new(3);
+    thread_pool_skew_t skew = { .sum = 0 };
+
+    for (int round = 0; round < 20; ++round) {
+        thread_pool_for(pool, 1000, 1, thread_pool_skew_fn, &skew);
+    }
+
+    TEST_ASSERT_EQUAL(20 * 999 * 1000 / 2, skew.sum);
+
+    thread_pool_free(pool);
+}
+
+typedef struct thread_pool_nested_t {
+    thread_pool_t* pool;
+    _Atomic int64_t counts[64];
+} thread_pool_nested_t;
+
+void thread_pool_nested_fn(int64_t start, int64_t end, void* ctx) {
+    thread_pool_nested_t* nested = ctx;
+
+    for (int64_t n = start; n < end; ++n) {
+        thread_pool_for(nested->pool, 64, 8, thread_pool_count_fn, nested->counts);
+    }
+}
+
+void test_thread_pool_for_should_run_nested_loops_inline(void) {
+    thread_pool_nested_t nested = { .pool = thread_pool_new(4) };
+
+    for (int n = 0; n < 64; ++n) {
+        atomic_init(&nested.counts[n], 0);
+    }
+
+    thread_pool_for(nested.pool, 10, 1, thread_pool_nested_fn, &nested);
+
+    for (int n = 0; n < 64; ++n) {
+        TEST_ASSERT_EQUAL(10, nested.counts[n]);
+    }
+
+    thread_pool_free(nested.pool);
+}
+
+void test_thread_pool_default_should_return_shared_pool(void) {
+    thread_pool_t* pool = thread_pool_default();
+
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL_PTR(pool, thread_pool_default());
+    TEST_ASSERT_TRUE(thread_pool_size(pool) >= 1);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_thread_pool_default_should_return_shared_pool);
+    RUN_TEST(test_thread_pool_for_should_finish_uneven_chunks);
+    RUN_TEST(test_thread_pool_for_should_run_nested_loops_inline);
+    RUN_TEST(test_thread_pool_for_should_visit_every_index_once);
+
+    return UNITY_END();
+}
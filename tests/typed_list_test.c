@@ -0,0 +1,161 @@
+#include "unity.h"
+
+#include "typed_list.h"
+
+typedef struct point_t {
+    int32_t x;
+    int32_t y;
+} point_t;
+
+bool point_equal(point_t const* lhs, point_t const* rhs) {
+    return lhs->x == rhs->x && lhs->y == rhs->y;
+}
+
+CRUMB_DECLARE_LIST(point_list, point_t, point_equal)
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_typed_list_append_should_store_values_inline(void) {
+    i64list_t* list = i64list_new(0);
+
+    for (int64_t n = 0; n < 100000; ++n) {
+        list = i64list_append(list, n * 3);
+    }
+
+    TEST_ASSERT_EQUAL(100000, i64list_size(list));
+    TEST_ASSERT_TRUE(i64list_capacity(list) >= 100000);
+
+    int64_t sum = 0;
+    for (int64_t n = 0; n < i64list_size(list); ++n) {
+        sum += list->buf[n];
+    }
+
+    TEST_ASSERT_EQUAL(3 * (100000LL * 99999 / 2), sum);
+    TEST_ASSERT_EQUAL(299997, *i64list_get(list, 99999));
+    TEST_ASSERT_NULL(i64list_get(list, 100000));
+    TEST_ASSERT_NULL(i64list_get(list, -1));
+
+    i64list_free(list);
+}
+
+void test_typed_list_insert_and_pop_should_shift_values(void) {
+    i64list_t* list = i64list_new(2);
+    int64_t value = 0;
+
+    i64list_append(i64list_append(list, 2), 4);
+    i64list_prepend(list, 1);
+
+    TEST_ASSERT_TRUE(i64list_insert(list, 2, 3));
+    TEST_ASSERT_TRUE(i64list_insert(list, 4, 5));
+    TEST_ASSERT_FALSE(i64list_insert(list, 6, 7));
+
+    for (int64_t n = 0; n < 5; ++n) {
+        TEST_ASSERT_EQUAL(n + 1, *i64list_get(list, n));
+    }
+
+    TEST_ASSERT_TRUE(i64list_pop(list, 0, &value));
+    TEST_ASSERT_EQUAL(1, value);
+    TEST_ASSERT_TRUE(i64list_pop(list, 3, NULL));
+    TEST_ASSERT_FALSE(i64list_pop(list, 3, &value));
+    TEST_ASSERT_EQUAL(3, i64list_size(list));
+    TEST_ASSERT_EQUAL(1, i64list_find(list, 3));
+    TEST_ASSERT_EQUAL(-1, i64list_find(list, 5));
+
+    TEST_ASSERT_TRUE(i64list_set(list, 0, 42));
+    TEST_ASSERT_FALSE(i64list_set(list, 3, 42));
+    TEST_ASSERT_EQUAL(42, *i64list_get(list, 0));
+
+    i64list_free(list);
+}
+
+void test_typed_list_slice_and_extend_should_copy_values(void) {
+    f64list_t* list = f64list_new(4);
+
+    for (int64_t n = 0; n < 10; ++n) {
+        f64list_append(list, n * 0.5);
+    }
+
+    f64list_t* slice = f64list_slice(list, 2, 6);
+    f64list_t* copy = f64list_copy(slice);
+
+    TEST_ASSERT_NULL(f64list_slice(list, 6, 2));
+    TEST_ASSERT_NULL(f64list_slice(list, 0, 11));
+    TEST_ASSERT_EQUAL(4, f64list_size(slice));
+    TEST_ASSERT_EQUAL_DOUBLE(1.0, *f64list_get(slice, 0));
+    TEST_ASSERT_TRUE(f64list_equal(slice, copy));
+
+    f64list_extend(copy, slice);
+
+    TEST_ASSERT_EQUAL(8, f64list_size(copy));
+    TEST_ASSERT_EQUAL_DOUBLE(2.5, *f64list_get(copy, 7));
+    TEST_ASSERT_FALSE(f64list_equal(slice, copy));
+
+    f64list_clear(copy);
+    TEST_ASSERT_EQUAL(0, f64list_size(copy));
+
+    f64list_free(list);
+    f64list_free(slice);
+    f64list_free(copy);
+}
+
+void test_typed_list_find_should_compare_doubles_by_value(void) {
+    f64list_t* lhs = f64list_new(4);
+    f64list_t* rhs = f64list_new(4);
+    double nan = __builtin_nan("");
+
+    f64list_append(f64list_append(lhs, -0.0), 1.0);
+    f64list_append(f64list_append(rhs, 0.0), 1.0);
+
+    // -0.0 and 0.0 differ in their sign bit but compare equal.
+    TEST_ASSERT_EQUAL(0, f64list_find(lhs, 0.0));
+    TEST_ASSERT_TRUE(f64list_equal(lhs, rhs));
+
+    f64list_append(lhs, nan);
+    f64list_append(rhs, nan);
+
+    // NaN is equal to nothing, itself included.
+    TEST_ASSERT_EQUAL(-1, f64list_find(lhs, nan));
+    TEST_ASSERT_FALSE(f64list_equal(lhs, rhs));
+    TEST_ASSERT_TRUE(f64list_equal(lhs, lhs));
+
+    f64list_free(lhs);
+    f64list_free(rhs);
+}
+
+void point_list_flip_fn(point_t* point) {
+    int32_t x = point->x;
+
+    point->x = point->y;
+    point->y = x;
+}
+
+void test_typed_list_should_store_structs_contiguously(void) {
+    point_list_t* list = point_list_new(4);
+
+    for (int32_t n = 0; n < 10; ++n) {
+        point_list_append(list, (point_t) { .x = n, .y = -n });
+    }
+
+    point_list_foreach(list, point_list_flip_fn);
+
+    TEST_ASSERT_EQUAL_PTR(point_list_get(list, 0) + 9, point_list_get(list, 9));
+    TEST_ASSERT_EQUAL(-9, point_list_get(list, 9)->x);
+    TEST_ASSERT_EQUAL(9, point_list_get(list, 9)->y);
+    TEST_ASSERT_EQUAL(3, point_list_find(list, (point_t) { .x = -3, .y = 3 }));
+
+    point_list_free(list);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_typed_list_append_should_store_values_inline);
+    RUN_TEST(test_typed_list_find_should_compare_doubles_by_value);
+    RUN_TEST(test_typed_list_insert_and_pop_should_shift_values);
+    RUN_TEST(test_typed_list_slice_and_extend_should_copy_values);
+    RUN_TEST(test_typed_list_should_store_structs_contiguously);
+
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+#include "unity.h"
+
+#include "u64map.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_u64map_set_should_set_key_to_value(void) {
+    u64map_t* map = u64map_new(4);
+
+    map = u64map_set(map, 42, (void*) 1);
+    map = u64map_set(map, 42, (void*) 2);
+
+    TEST_ASSERT_EQUAL_PTR((void*) 2, u64map_get(map, 42));
+    TEST_ASSERT_EQUAL_PTR(NULL, u64map_get(map, 43));
+    TEST_ASSERT_EQUAL(1, u64map_size(map));
+
+    u64map_free(map);
+}
+
+void test_u64map_set_should_store_zero_key(void) {
+    u64map_t* map = u64map_new(4);
+
+    TEST_ASSERT_FALSE(u64map_contains(map, 0));
+
+    map = u64map_set(map, 0, (void*) 1);
+    map = u64map_set(map, 0, (void*) 2);
+
+    TEST_ASSERT_TRUE(u64map_contains(map, 0));
+    TEST_ASSERT_EQUAL_PTR((void*) 2, u64map_get(map, 0));
+    TEST_ASSERT_EQUAL(1, u64map_size(map));
+    TEST_ASSERT_EQUAL_PTR((void*) 2, u64map_delete(map, 0));
+    TEST_ASSERT_FALSE(u64map_contains(map, 0));
+    TEST_ASSERT_EQUAL(0, u64map_size(map));
+
+    u64map_free(map);
+}
+
+void test_u64map_set_should_grow_past_initial_capacity(void) {
+    u64map_t* map = u64map_new(1);
+
+    for (uint64_t n = 0; n < 100000; ++n) {
+        map = u64map_set(map, n, (void*) (n + 1));
+    }
+
+    TEST_ASSERT_EQUAL(100000, u64map_size(map));
+
+    for (uint64_t n = 0; n < 100000; ++n) {
+        TEST_ASSERT_EQUAL_PTR((void*) (n + 1), u64map_get(map, n));
+    }
+
+    u64map_free(map);
+}
+
+void test_u64map_delete_should_keep_other_keys_reachable(void) {
+    u64map_t* map = u64map_new(1);
+
+    for (uint64_t n = 1; n <= 10000; ++n) {
+        map = u64map_set(map, n * 64, (void*) n);
+    }
+
+    for (uint64_t n = 1; n <= 10000; n += 2) {
+        TEST_ASSERT_EQUAL_PTR((void*) n, u64map_delete(map, n * 64));
+        TEST_ASSERT_EQUAL_PTR(NULL, u64map_delete(map, n * 64));
+    }
+
+    TEST_ASSERT_EQUAL(5000, u64map_size(map));
+
+    for (uint64_t n = 1; n <= 10000; ++n) {
+        TEST_ASSERT_EQUAL(n % 2 == 0, u64map_contains(map, n * 64));
+    }
+
+    u64map_free(map);
+}
+
+void test_u64map_clear_should_remove_all_elements(void) {
+    u64map_t* map = u64map_new(4);
+
+    map = u64map_set(u64map_set(map, 0, (void*) 1), 7, (void*) 2);
+    map = u64map_clear(map);
+
+    TEST_ASSERT_EQUAL(0, u64map_size(map));
+    TEST_ASSERT_FALSE(u64map_contains(map, 0));
+    TEST_ASSERT_FALSE(u64map_contains(map, 7));
+
+    u64map_free(map);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_u64map_clear_should_remove_all_elements);
+    RUN_TEST(test_u64map_delete_should_keep_other_keys_reachable);
+    RUN_TEST(test_u64map_set_should_grow_past_initial_capacity);
+    RUN_TEST(test_u64map_set_should_set_key_to_value);
+    RUN_TEST(test_u64map_set_should_store_zero_key);
+
+    return UNITY_END();
+}